@@ -0,0 +1,1038 @@
+// Headless benchmark harness for the search core. Runs every algorithm over a
+// reproducible corpus of seeded random maps, seeded mazes and optional map
+// files, and reports
+// latency percentiles and search counters as CSV or JSON. With --scen it runs
+// MovingAI scenario suites instead and checks every path against the reference
+// lengths, with --tiled it searches out-of-core tiled maps, and with --check it
+// runs built-in regression checks.
+//
+// Build: g++ -std=c++17 -O2 -pthread -Isrc src/bench/benchmark.cpp -o bin/benchmark
+#include "core/AnytimeSearch.hpp"
+#include "core/BatchSearch.hpp"
+#include "core/MapIO.hpp"
+#include "core/MazeGenerator.hpp"
+#include "core/Pathfinder.hpp"
+#include "core/SearchStats.hpp"
+#include "core/TiledSearch.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+using namespace std;
+using namespace chrono;
+using namespace Pathfinding;
+
+// Global allocation tracking, used to report the peak heap footprint of a run.
+namespace Memory {
+    atomic<size_t> current{ 0 };
+    atomic<size_t> peak{ 0 };
+
+    void resetPeak() { peak.store(current.load()); }
+}
+
+void* operator new(size_t size) {
+    // Store the size in front of the block so delete can account for it.
+    void* block = malloc(size + alignof(max_align_t));
+    if (!block) throw bad_alloc();
+    *static_cast<size_t*>(block) = size;
+    AllocationCounter::record(size);
+    size_t now = Memory::current.fetch_add(size) + size;
+    size_t peak = Memory::peak.load();
+    while (now > peak && !Memory::peak.compare_exchange_weak(peak, now)) {}
+    return static_cast<char*>(block) + alignof(max_align_t);
+}
+
+void operator delete(void* ptr) noexcept {
+    if (!ptr) return;
+    void* block = static_cast<char*>(ptr) - alignof(max_align_t);
+    Memory::current.fetch_sub(*static_cast<size_t*>(block));
+    free(block);
+}
+
+void operator delete(void* ptr, size_t) noexcept { operator delete(ptr); }
+
+struct MapCase {
+    string name;
+    Grid grid;
+    Point start, end;
+};
+
+struct Options {
+    vector<int> sizes = { 64, 256, 1024 };
+    vector<double> densities = { 0.1, 0.2, 0.3 };
+    int seeds = 3;
+    int warmup = 3;
+    int runs = 20;
+    int batch = 0;
+    int terrain = 1;
+    vector<MazeAlgorithm> mazes;
+    double braid = 0.0;
+    vector<int> anytimeBudgetsUs;
+    Connectivity moves = Connectivity::Four;
+    unsigned threads = thread::hardware_concurrency();
+    vector<string> mapFiles;
+    vector<string> scenFiles;
+    string mapDir;
+    vector<string> tiledFiles;
+    string makeTiled;
+    size_t tileCacheMb = 256;
+    size_t tileStateMb = 2048;
+    bool check = false;
+    vector<Algorithm> algorithms = { Algorithm::BFS, Algorithm::DFS, Algorithm::AStar, Algorithm::Dijkstra, Algorithm::Greedy,
+        Algorithm::JPS, Algorithm::JPSPlus, Algorithm::BidirectionalBFS, Algorithm::BidirectionalAStar,
+        Algorithm::Wavefront, Algorithm::DStarLite, Algorithm::HPAStar, Algorithm::ALT, Algorithm::FlowField };
+    string format = "csv";
+    string output;
+};
+
+const char* algorithmName(Algorithm algo) {
+    switch (algo) {
+    case Algorithm::BFS: return "BFS";
+    case Algorithm::DFS: return "DFS";
+    case Algorithm::AStar: return "AStar";
+    case Algorithm::Dijkstra: return "Dijkstra";
+    case Algorithm::Greedy: return "Greedy";
+    case Algorithm::JPS: return "JPS";
+    case Algorithm::JPSPlus: return "JPSPlus";
+    case Algorithm::BidirectionalBFS: return "BiBFS";
+    case Algorithm::BidirectionalAStar: return "BiAStar";
+    case Algorithm::Wavefront: return "Wavefront";
+    case Algorithm::DStarLite: return "DStarLite";
+    case Algorithm::HPAStar: return "HPAStar";
+    case Algorithm::ALT: return "ALT";
+    case Algorithm::FlowField: return "FlowField";
+    }
+    return "?";
+}
+
+const char* mazeName(MazeAlgorithm maze) {
+    switch (maze) {
+    case MazeAlgorithm::Backtracker: return "backtracker";
+    case MazeAlgorithm::Kruskal: return "kruskal";
+    case MazeAlgorithm::Prim: return "prim";
+    case MazeAlgorithm::Eller: return "eller";
+    case MazeAlgorithm::Wilson: return "wilson";
+    }
+    return "?";
+}
+
+bool parseMaze(const string& name, MazeAlgorithm& maze) {
+    for (MazeAlgorithm m : { MazeAlgorithm::Backtracker, MazeAlgorithm::Kruskal, MazeAlgorithm::Prim, MazeAlgorithm::Eller,
+        MazeAlgorithm::Wilson }) {
+        if (name == mazeName(m)) {
+            maze = m;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool parseAlgorithm(const string& name, Algorithm& algo) {
+    for (Algorithm a : Options().algorithms) {
+        string candidate = algorithmName(a);
+        if (equal(name.begin(), name.end(), candidate.begin(), candidate.end(),
+            [](char l, char r) { return tolower(l) == tolower(r); })) {
+            algo = a;
+            return true;
+        }
+    }
+    return false;
+}
+
+template <class T, class Parse>
+vector<T> parseList(const string& text, Parse parse) {
+    vector<T> values;
+    stringstream in(text);
+    string item;
+    while (getline(in, item, ',')) values.push_back(parse(item));
+    return values;
+}
+
+void printUsage() {
+    cerr << "Usage: benchmark [options]\n"
+        << "  --sizes 64,256,1024      square map sizes to generate\n"
+        << "  --densities 0.1,0.2,0.3  wall probabilities to generate\n"
+        << "  --seeds N                maps per size/density pair (default 3)\n"
+        << "  --mazes a,b,...          also generate mazes of each size: backtracker,kruskal,\n"
+        << "                           prim,eller,wilson (seeds per size as above)\n"
+        << "  --braid F                fraction of maze dead ends opened into loops (default 0)\n"
+        << "  --map FILE               add an ASCII or MovingAI .map file (repeatable)\n"
+        << "  --scen FILE              run a MovingAI scenario file instead (repeatable)\n"
+        << "  --map-dir DIR            where --scen looks for maps (default: beside the .scen)\n"
+        << "  --tiled FILE             search a tiled map with bfs, dijkstra and astar instead\n"
+        << "                           (repeatable); each runs once on a cold tile cache\n"
+        << "  --make-tiled FILE        first write a random tiled map to FILE, sized by the\n"
+        << "                           first --sizes and --densities entries, and search it\n"
+        << "  --tile-cache MB          tile cache per tiled search (default 256)\n"
+        << "  --tile-state MB          give up a tiled search past this much memory (default 2048)\n"
+        << "  --algorithms a,b,...     subset of bfs,dfs,astar,dijkstra,greedy,jps,jpsplus,\n"
+        << "                           bibfs,biastar,wavefront,dstarlite,hpastar,alt,flowfield\n"
+        << "  --warmup N --runs N      untimed and timed runs per case (default 3/20)\n"
+        << "  --terrain N              random cell costs 1..N on generated maps (default 1)\n"
+        << "  --moves 4|8              neighbourhood for dijkstra, astar and greedy (default 4)\n"
+        << "  --anytime 1000,10000     also run ARA* with each time budget in microseconds\n"
+        << "  --batch N                also time N random queries per case on the thread pool\n"
+        << "  --threads N              pool size for --batch (default: hardware threads)\n"
+        << "  --format csv|json        output format (default csv)\n"
+        << "  --out FILE               write results to FILE instead of stdout\n"
+        << "  --check                  run the built-in regression checks instead\n";
+}
+
+bool parseOptions(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--check") {
+            options.check = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            printUsage();
+            return false;
+        }
+        string value = argv[++i];
+
+        if (arg == "--sizes") options.sizes = parseList<int>(value, [](const string& s) { return stoi(s); });
+        else if (arg == "--densities") options.densities = parseList<double>(value, [](const string& s) { return stod(s); });
+        else if (arg == "--seeds") options.seeds = stoi(value);
+        else if (arg == "--map") options.mapFiles.push_back(value);
+        else if (arg == "--scen") options.scenFiles.push_back(value);
+        else if (arg == "--map-dir") options.mapDir = value;
+        else if (arg == "--tiled") options.tiledFiles.push_back(value);
+        else if (arg == "--make-tiled") options.makeTiled = value;
+        else if (arg == "--tile-cache") options.tileCacheMb = max(1, stoi(value));
+        else if (arg == "--tile-state") options.tileStateMb = max(1, stoi(value));
+        else if (arg == "--warmup") options.warmup = stoi(value);
+        else if (arg == "--runs") options.runs = max(1, stoi(value));
+        else if (arg == "--anytime") options.anytimeBudgetsUs = parseList<int>(value, [](const string& s) { return max(1, stoi(s)); });
+        else if (arg == "--braid") options.braid = max(0.0, min(stod(value), 1.0));
+        else if (arg == "--terrain") options.terrain = max(1, min(stoi(value), Grid::kMaxCost));
+        else if (arg == "--moves") options.moves = value == "8" ? Connectivity::Eight : Connectivity::Four;
+        else if (arg == "--batch") options.batch = max(0, stoi(value));
+        else if (arg == "--threads") options.threads = max(1, stoi(value));
+        else if (arg == "--format") options.format = value;
+        else if (arg == "--out") options.output = value;
+        else if (arg == "--mazes") {
+            options.mazes.clear();
+            for (const string& name : parseList<string>(value, [](const string& s) { return s; })) {
+                MazeAlgorithm maze;
+                if (!parseMaze(name, maze)) {
+                    cerr << "Unknown maze algorithm: " << name << endl;
+                    return false;
+                }
+                options.mazes.push_back(maze);
+            }
+        }
+        else if (arg == "--algorithms") {
+            options.algorithms.clear();
+            for (const string& name : parseList<string>(value, [](const string& s) { return s; })) {
+                Algorithm algo;
+                if (!parseAlgorithm(name, algo)) {
+                    cerr << "Unknown algorithm: " << name << endl;
+                    return false;
+                }
+                options.algorithms.push_back(algo);
+            }
+        }
+        else {
+            printUsage();
+            return false;
+        }
+    }
+    return true;
+}
+
+// Queries run corner to corner: from the first open cell in reading order to the last one.
+bool pickEndpoints(MapCase& map) {
+    const Grid& grid = map.grid;
+    int first = -1, last = -1;
+    for (int i = 0; i < grid.cellCount() && first == -1; ++i) {
+        if (!grid.isWall(i)) first = i;
+    }
+    for (int i = grid.cellCount() - 1; i >= 0 && last == -1; --i) {
+        if (!grid.isWall(i)) last = i;
+    }
+    if (first == -1 || first == last) return false;
+    map.start = grid.point(first);
+    map.end = grid.point(last);
+    return true;
+}
+
+// MovingAI maps by their .map extension, ASCII maps otherwise.
+Grid loadMap(const string& path) {
+    if (filesystem::path(path).extension() == ".map") return MapIO::loadMovingAIMap(path);
+    return MapIO::loadAsciiMap(path);
+}
+
+vector<MapCase> buildCorpus(const Options& options) {
+    vector<MapCase> corpus;
+    for (int size : options.sizes) {
+        for (double density : options.densities) {
+            for (int seed = 0; seed < options.seeds; ++seed) {
+                string name = "random-" + to_string(size) + "-" + to_string(density).substr(0, 4) + "-s" + to_string(seed);
+                if (options.terrain > 1) name += "-t" + to_string(options.terrain);
+                MapCase map{ name, Grid(size, size), {}, {} };
+                MazeGenerator::generateRandomWalls(map.grid, density, seed);
+                if (options.terrain > 1) MazeGenerator::generateTerrain(map.grid, options.terrain, seed);
+                // Keep the corners open so every map has a well-defined query.
+                map.grid.setWall(0, 0, false);
+                map.grid.setWall(size - 1, size - 1, false);
+                map.start = { 0, 0 };
+                map.end = { size - 1, size - 1 };
+                corpus.push_back(move(map));
+            }
+        }
+    }
+    // Mazes run from the first room to the last, the farthest apart along
+    // the walls. Generation splits into tiles on its own pool.
+    ThreadPool pool(options.mazes.empty() ? 1 : options.threads);
+    for (int size : options.sizes) {
+        if (size < 3) continue;
+        for (MazeAlgorithm maze : options.mazes) {
+            for (int seed = 0; seed < options.seeds; ++seed) {
+                string name = "maze-" + string(mazeName(maze)) + "-" + to_string(size) + "-s" + to_string(seed);
+                if (options.braid > 0) name += "-b" + to_string(options.braid).substr(0, 4);
+                if (options.terrain > 1) name += "-t" + to_string(options.terrain);
+                MapCase map{ name, Grid(size, size), {}, {} };
+                MazeGenerator::generateMaze(map.grid, maze, seed, options.braid, &pool);
+                if (options.terrain > 1) MazeGenerator::generateTerrain(map.grid, options.terrain, seed);
+                int last = (size - 1) / 2 * 2 - 1;
+                map.start = { 1, 1 };
+                map.end = { last, last };
+                corpus.push_back(move(map));
+            }
+        }
+    }
+    for (const string& file : options.mapFiles) {
+        MapCase map{ file, loadMap(file), {}, {} };
+        if (pickEndpoints(map)) corpus.push_back(move(map));
+        else cerr << "Skipping " << file << ": fewer than two open cells" << endl;
+    }
+    return corpus;
+}
+
+struct Measurement {
+    string map;
+    int width = 0, height = 0;
+    string algorithm;
+    bool found = false;
+    size_t pathLength = 0;
+    SearchStats stats;
+    size_t peakBytes = 0;
+    int64_t medianNs = 0, p95Ns = 0, p99Ns = 0;
+    double batchQps = 0;
+    double bound = 0;  // anytime rows: the path costs at most bound x optimal
+};
+
+int64_t percentile(const vector<int64_t>& sorted, double p) {
+    size_t rank = static_cast<size_t>(p * sorted.size() + 0.999999);
+    return sorted[min(sorted.size(), max<size_t>(rank, 1)) - 1];
+}
+
+// Random open start/goal pairs, seeded per map so every algorithm gets the same batch.
+vector<Query> makeQueries(const MapCase& map, int count) {
+    const Grid& grid = map.grid;
+    mt19937_64 rng(hash<string>()(map.name));
+    uniform_int_distribution<int> cell(0, grid.cellCount() - 1);
+    auto openCell = [&]() {
+        for (int attempt = 0; attempt < 64; ++attempt) {
+            int i = cell(rng);
+            if (!grid.isWall(i)) return grid.point(i);
+        }
+        return map.start;
+    };
+
+    vector<Query> queries(count);
+    for (Query& q : queries) q = { openCell(), openCell() };
+    return queries;
+}
+
+// Queries per second over one batch, after an untimed batch that warms the arenas.
+double measureBatch(const MapCase& map, Algorithm algo, BatchSearch& batch, const vector<Query>& queries, Connectivity moves) {
+    vector<SearchResult> results(queries.size());
+    batch.run(algo, map.grid, queries.data(), queries.size(), results.data(), moves);
+
+    auto begin = steady_clock::now();
+    batch.run(algo, map.grid, queries.data(), queries.size(), results.data(), moves);
+    double seconds = duration<double>(steady_clock::now() - begin).count();
+    return seconds > 0 ? queries.size() / seconds : 0;
+}
+
+Measurement measure(const MapCase& map, Algorithm algo, const Options& options) {
+    Measurement m;
+    m.map = map.name;
+    m.width = map.grid.width();
+    m.height = map.grid.height();
+    m.algorithm = algorithmName(algo);
+
+    // Counters and peak memory come from one untimed, instrumented run. It gets
+    // a fresh arena so the scratch memory is counted; timed runs reuse the
+    // thread's arena like a long-running caller would.
+    StatsObserver counter;
+    Memory::resetPeak();
+    size_t baseline = Memory::current.load();
+    SearchArena arena;
+    SearchResult result = Pathfinder::findPath(algo, map.grid, map.start, map.end, counter, arena, options.moves);
+    m.peakBytes = Memory::peak.load() - baseline;
+    m.found = result.found;
+    m.pathLength = result.path.empty() ? 0 : result.path.size() - 1;
+    m.stats = counter.stats();
+
+    for (int i = 0; i < options.warmup; ++i) Pathfinder::findPath(algo, map.grid, map.start, map.end, options.moves);
+
+    vector<int64_t> samples;
+    samples.reserve(options.runs);
+    for (int i = 0; i < options.runs; ++i) {
+        auto begin = steady_clock::now();
+        SearchResult run = Pathfinder::findPath(algo, map.grid, map.start, map.end, options.moves);
+        samples.push_back(duration_cast<nanoseconds>(steady_clock::now() - begin).count());
+        if (run.found != result.found) cerr << "Warning: nondeterministic result on " << map.name << endl;
+    }
+    sort(samples.begin(), samples.end());
+    m.medianNs = percentile(samples, 0.5);
+    m.p95Ns = percentile(samples, 0.95);
+    m.p99Ns = percentile(samples, 0.99);
+    return m;
+}
+
+// ARA* given budgetUs per query, each query from scratch on a planner whose
+// memory is already warm, as a real-time caller would run it. Peak memory
+// comes from the first, cold run; counters and the bound from an untimed
+// warm one.
+template <class Moves, class Heuristic>
+Measurement measureAnytime(const MapCase& map, int budgetUs, const Options& options) {
+    Measurement m;
+    m.map = map.name;
+    m.width = map.grid.width();
+    m.height = map.grid.height();
+    m.algorithm = "ARAStar@" + to_string(budgetUs) + "us";
+    int start = map.grid.index(map.start.x, map.start.y), end = map.grid.index(map.end.x, map.end.y);
+    microseconds budget(budgetUs);
+    AnytimePlanner<Moves, Heuristic> planner;
+    NullObserver observer;
+
+    Memory::resetPeak();
+    size_t baseline = Memory::current.load();
+    planner.plan(map.grid, start, end, AnytimeBudget::within(budget), observer);
+    m.peakBytes = Memory::peak.load() - baseline;
+
+    for (int i = 0; i < options.warmup; ++i) {
+        planner.invalidate();
+        planner.plan(map.grid, start, end, AnytimeBudget::within(budget), observer);
+    }
+
+    StatsObserver counter;
+    planner.invalidate();
+    AnytimeResult result = planner.plan(map.grid, start, end, AnytimeBudget::within(budget), counter);
+    m.found = result.found;
+    m.pathLength = result.path.empty() ? 0 : result.path.size() - 1;
+    m.stats = counter.stats();
+    m.bound = result.bound;
+
+    vector<int64_t> samples;
+    samples.reserve(options.runs);
+    for (int i = 0; i < options.runs; ++i) {
+        planner.invalidate();
+        auto begin = steady_clock::now();
+        planner.plan(map.grid, start, end, AnytimeBudget::within(budget), observer);
+        samples.push_back(duration_cast<nanoseconds>(steady_clock::now() - begin).count());
+    }
+    sort(samples.begin(), samples.end());
+    m.medianNs = percentile(samples, 0.5);
+    m.p95Ns = percentile(samples, 0.95);
+    m.p99Ns = percentile(samples, 0.99);
+    return m;
+}
+
+Measurement measureAnytime(const MapCase& map, int budgetUs, const Options& options) {
+    if (options.moves == Connectivity::Eight) return measureAnytime<EightConnected<>, OctileHeuristic>(map, budgetUs, options);
+    return measureAnytime<FourConnected, ManhattanHeuristic>(map, budgetUs, options);
+}
+
+// Empty in CSV and null in JSON on rows other than anytime ones, and in
+// JSON while no bound is known.
+void writeBound(ostream& out, double bound, bool json) {
+    if (bound <= 0 || (json && isinf(bound))) out << (json ? "null" : "");
+    else out << bound;
+}
+
+void writeCsv(ostream& out, const vector<Measurement>& results) {
+    out << "map,width,height,algorithm,found,path_length,nodes_expanded,queue_pushes,peak_bytes,median_ns,p95_ns,p99_ns,batch_qps,"
+        << "nodes_generated,queue_pops,stale_pops,peak_open,alloc_bytes,setup_ns,search_ns,reconstruct_ns,bound\n";
+    for (const Measurement& m : results) {
+        const SearchStats& s = m.stats;
+        out << m.map << ',' << m.width << ',' << m.height << ',' << m.algorithm << ','
+            << (m.found ? 1 : 0) << ',' << m.pathLength << ',' << s.expanded << ',' << s.pushes << ','
+            << m.peakBytes << ',' << m.medianNs << ',' << m.p95Ns << ',' << m.p99Ns << ',' << m.batchQps << ','
+            << s.generated << ',' << s.pops << ',' << s.stalePops << ',' << s.peakOpen << ',' << s.bytesAllocated << ','
+            << s.setupNs << ',' << s.searchNs << ',' << s.reconstructNs << ',';
+        writeBound(out, m.bound, false);
+        out << '\n';
+    }
+}
+
+string jsonEscape(const string& text) {
+    string escaped;
+    for (char c : text) {
+        if (c == '"' || c == '\\') escaped += '\\';
+        escaped += c;
+    }
+    return escaped;
+}
+
+void writeJson(ostream& out, const vector<Measurement>& results) {
+    out << "[\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Measurement& m = results[i];
+        out << "  {\"map\": \"" << jsonEscape(m.map) << "\", \"width\": " << m.width << ", \"height\": " << m.height
+            << ", \"algorithm\": \"" << m.algorithm << "\", \"found\": " << (m.found ? "true" : "false")
+            << ", \"path_length\": " << m.pathLength << ", \"nodes_expanded\": " << m.stats.expanded
+            << ", \"queue_pushes\": " << m.stats.pushes << ", \"peak_bytes\": " << m.peakBytes
+            << ", \"median_ns\": " << m.medianNs << ", \"p95_ns\": " << m.p95Ns << ", \"p99_ns\": " << m.p99Ns
+            << ", \"batch_qps\": " << m.batchQps << ", \"nodes_generated\": " << m.stats.generated
+            << ", \"queue_pops\": " << m.stats.pops << ", \"stale_pops\": " << m.stats.stalePops
+            << ", \"peak_open\": " << m.stats.peakOpen << ", \"alloc_bytes\": " << m.stats.bytesAllocated
+            << ", \"setup_ns\": " << m.stats.setupNs << ", \"search_ns\": " << m.stats.searchNs
+            << ", \"reconstruct_ns\": " << m.stats.reconstructNs << ", \"bound\": ";
+        writeBound(out, m.bound, true);
+        out << "}" << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    out << "]\n";
+}
+
+// Scenario suites. Results are grouped by .scen file, bucket and algorithm.
+struct BucketResult {
+    string scen;
+    int bucket = 0;
+    string algorithm;
+    string reference;          // "scen", or "4way" for algorithms without diagonal moves
+    int scenarios = 0;
+    int solved = 0;            // a path was found
+    int optimal = 0;           // ... and its length matched the reference
+    double maxExcess = 0;      // largest amount a path exceeded the reference by
+    int64_t medianNs = 0;
+    double meanExpanded = 0;
+};
+
+// Dijkstra, A* and greedy search honour diagonal moves, so they run 8-way and
+// are checked against the scenario's own optimal length. The others, ALT
+// among them since 8-way ALT is plain A*, move 4-way and are checked against
+// a 4-way Dijkstra on the same query.
+bool movesDiagonally(Algorithm algo) {
+    return algo == Algorithm::AStar || algo == Algorithm::Dijkstra || algo == Algorithm::Greedy;
+}
+
+Connectivity scenarioMoves(Algorithm algo) {
+    return movesDiagonally(algo) ? Connectivity::Eight : Connectivity::Four;
+}
+
+// Searches that promise shortest paths; a mismatch from one fails the run.
+bool isOptimal(Algorithm algo) {
+    return algo != Algorithm::DFS && algo != Algorithm::Greedy && algo != Algorithm::HPAStar;
+}
+
+// Length with straight steps costing 1 and diagonal steps sqrt(2), as in the
+// scenario files.
+double pathLength(const Grid& grid, const SearchResult& result) {
+    double length = 0;
+    for (size_t i = 1; i < result.path.size(); ++i) {
+        Point a = grid.point(result.path[i - 1]), b = grid.point(result.path[i]);
+        length += a.x != b.x && a.y != b.y ? sqrt(2.0) : 1.0;
+    }
+    return length;
+}
+
+// Scenario files name maps relative to a benchmark root; try the name as
+// written and then the bare file name, in --map-dir or beside the .scen file.
+string resolveMap(const string& scenPath, const string& mapDir, const string& map) {
+    filesystem::path dir = mapDir.empty() ? filesystem::path(scenPath).parent_path() : filesystem::path(mapDir);
+    for (const filesystem::path& candidate : { dir / map, dir / filesystem::path(map).filename() }) {
+        if (filesystem::exists(candidate)) return candidate.string();
+    }
+    throw runtime_error("Cannot find map " + map + " for " + scenPath);
+}
+
+// Runs every bucket of every scenario file with each algorithm. Returns false
+// if an optimal algorithm returned a path of the wrong length.
+bool runScenarios(const Options& options, vector<BucketResult>& results) {
+    bool passed = true;
+    string loadedPath;
+    Grid grid(0, 0);
+    for (const string& scenPath : options.scenFiles) {
+        vector<Scenario> scenarios = MapIO::loadScenarios(scenPath);
+        // Scenario indices grouped by bucket; files are usually in bucket order already.
+        vector<size_t> order(scenarios.size());
+        for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+        stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return scenarios[a].bucket < scenarios[b].bucket; });
+        // 4-way reference lengths, computed the first time an algorithm needs one.
+        vector<double> fourWay(scenarios.size(), -1.0);
+
+        for (size_t first = 0, last; first < order.size(); first = last) {
+            int bucket = scenarios[order[first]].bucket;
+            for (last = first; last < order.size() && scenarios[order[last]].bucket == bucket; ++last) {}
+
+            for (Algorithm algo : options.algorithms) {
+                BucketResult r{ scenPath, bucket, algorithmName(algo), movesDiagonally(algo) ? "scen" : "4way" };
+                Connectivity moves = scenarioMoves(algo);
+                cerr << scenPath << " bucket " << bucket << " / " << r.algorithm << endl;
+
+                vector<int64_t> samples;
+                for (size_t k = first; k < last; ++k) {
+                    size_t i = order[k];
+                    const Scenario& scenario = scenarios[i];
+                    string mapPath = resolveMap(scenPath, options.mapDir, scenario.map);
+                    if (mapPath != loadedPath) {
+                        grid = loadMap(mapPath);
+                        loadedPath = mapPath;
+                    }
+                    if (grid.width() != scenario.width || grid.height() != scenario.height ||
+                        !grid.inBounds(scenario.start.x, scenario.start.y) || !grid.inBounds(scenario.goal.x, scenario.goal.y)) {
+                        throw runtime_error("Scenario does not fit " + mapPath + " in " + scenPath);
+                    }
+
+                    double reference = scenario.optimal;
+                    if (!movesDiagonally(algo)) {
+                        if (fourWay[i] < 0) {
+                            fourWay[i] = pathLength(grid, Pathfinder::findPath(Algorithm::Dijkstra, grid, scenario.start, scenario.goal));
+                        }
+                        reference = fourWay[i];
+                    }
+
+                    StatsObserver counter;
+                    SearchResult result = Pathfinder::findPath(algo, grid, scenario.start, scenario.goal, counter, moves);
+                    samples.push_back(counter.stats().totalNs());
+                    r.meanExpanded += counter.stats().expanded;
+                    ++r.scenarios;
+                    if (!result.found) continue;
+                    ++r.solved;
+                    // Diagonals cost 99/70 in the search, a hair above sqrt(2),
+                    // so long paths may differ from the reference by rounding.
+                    double excess = pathLength(grid, result) - reference;
+                    r.maxExcess = max(r.maxExcess, excess);
+                    if (abs(excess) <= 1e-4 * reference + 1e-6) ++r.optimal;
+                }
+
+                sort(samples.begin(), samples.end());
+                if (!samples.empty()) r.medianNs = percentile(samples, 0.5);
+                if (r.scenarios > 0) r.meanExpanded /= r.scenarios;
+                if (isOptimal(algo) && r.optimal != r.scenarios) {
+                    cerr << "FAIL: " << r.algorithm << " matched " << r.optimal << " of " << r.scenarios
+                        << " reference lengths in bucket " << bucket << " of " << scenPath << endl;
+                    passed = false;
+                }
+                results.push_back(r);
+            }
+        }
+    }
+    return passed;
+}
+
+void writeScenarioCsv(ostream& out, const vector<BucketResult>& results) {
+    out << "scen,bucket,algorithm,reference,scenarios,solved,optimal,max_excess,median_ns,mean_expanded\n";
+    for (const BucketResult& r : results) {
+        out << r.scen << ',' << r.bucket << ',' << r.algorithm << ',' << r.reference << ',' << r.scenarios << ','
+            << r.solved << ',' << r.optimal << ',' << r.maxExcess << ',' << r.medianNs << ',' << r.meanExpanded << '\n';
+    }
+}
+
+void writeScenarioJson(ostream& out, const vector<BucketResult>& results) {
+    out << "[\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BucketResult& r = results[i];
+        out << "  {\"scen\": \"" << jsonEscape(r.scen) << "\", \"bucket\": " << r.bucket
+            << ", \"algorithm\": \"" << r.algorithm << "\", \"reference\": \"" << r.reference << "\""
+            << ", \"scenarios\": " << r.scenarios << ", \"solved\": " << r.solved << ", \"optimal\": " << r.optimal
+            << ", \"max_excess\": " << r.maxExcess << ", \"median_ns\": " << r.medianNs
+            << ", \"mean_expanded\": " << r.meanExpanded << "}"
+            << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    out << "]\n";
+}
+
+// Out-of-core searches over tiled maps, one row per map and algorithm.
+struct TiledMeasurement {
+    string map;
+    int width = 0, height = 0;
+    string algorithm;
+    bool found = false;
+    bool truncated = false;
+    size_t pathLength = 0;
+    int64_t cost = 0;
+    uint64_t expanded = 0;
+    int64_t timeNs = 0;
+    TileCacheStats cache;
+    size_t stateBytes = 0;
+    size_t cacheBytes = 0;
+};
+
+// The first open cell in reading order and the last one, as for map files.
+// Only the corners of the map are read unless they are walled in.
+bool pickEndpoints(TiledGrid& grid, Point& start, Point& end) {
+    int64_t first = -1, last = -1;
+    for (int64_t i = 0; i < grid.cellCount() && first == -1; ++i) {
+        if (!grid.isWall(static_cast<int>(i % grid.width()), static_cast<int>(i / grid.width()))) first = i;
+    }
+    for (int64_t i = grid.cellCount() - 1; i >= 0 && last == -1; --i) {
+        if (!grid.isWall(static_cast<int>(i % grid.width()), static_cast<int>(i / grid.width()))) last = i;
+    }
+    if (first == -1 || first == last) return false;
+    start = Point(static_cast<int>(first % grid.width()), static_cast<int>(first / grid.width()));
+    end = Point(static_cast<int>(last % grid.width()), static_cast<int>(last / grid.width()));
+    return true;
+}
+
+TiledSearchResult runTiled(Algorithm algo, TiledGrid& grid, Point start, Point end, Connectivity moves, size_t maxBytes) {
+    bool eight = moves == Connectivity::Eight;
+    switch (algo) {
+    case Algorithm::BFS: return TiledSearch::bfs(grid, start, end, maxBytes);
+    case Algorithm::Dijkstra:
+        return eight ? TiledSearch::dijkstra<EightConnected<>>(grid, start, end, maxBytes)
+            : TiledSearch::dijkstra<FourConnected>(grid, start, end, maxBytes);
+    default:
+        return eight ? TiledSearch::aStar<EightConnected<>, OctileHeuristic>(grid, start, end, maxBytes)
+            : TiledSearch::aStar<FourConnected, ManhattanHeuristic>(grid, start, end, maxBytes);
+    }
+}
+
+// Each search opens the map afresh, so every one starts on a cold tile cache
+// and its faults are comparable. A search that outgrows --tile-state gives up
+// and is reported as truncated. Algorithms other than BFS, Dijkstra and A*
+// have no tiled variant and are skipped.
+void runTiledMaps(const Options& options, vector<TiledMeasurement>& results) {
+    size_t cacheBytes = options.tileCacheMb << 20;
+    for (const string& path : options.tiledFiles) {
+        for (Algorithm algo : options.algorithms) {
+            if (algo != Algorithm::BFS && algo != Algorithm::Dijkstra && algo != Algorithm::AStar) continue;
+            TiledGrid grid(path, cacheBytes);
+            Point start, end;
+            if (!pickEndpoints(grid, start, end)) {
+                cerr << "Skipping " << path << ": fewer than two open cells" << endl;
+                break;
+            }
+            grid.resetCacheStats();
+            cerr << path << " / " << algorithmName(algo) << endl;
+
+            auto begin = steady_clock::now();
+            TiledSearchResult result = runTiled(algo, grid, start, end, options.moves, options.tileStateMb << 20);
+            TiledMeasurement m;
+            m.timeNs = duration_cast<nanoseconds>(steady_clock::now() - begin).count();
+            m.map = path;
+            m.width = grid.width();
+            m.height = grid.height();
+            m.algorithm = algorithmName(algo);
+            m.found = result.found;
+            m.truncated = result.truncated;
+            m.pathLength = result.path.empty() ? 0 : result.path.size() - 1;
+            m.cost = result.cost;
+            m.expanded = result.expanded;
+            m.cache = result.cache;
+            m.stateBytes = result.stateBytes;
+            m.cacheBytes = grid.cacheBytes();
+            results.push_back(m);
+        }
+    }
+}
+
+void writeTiledCsv(ostream& out, const vector<TiledMeasurement>& results) {
+    out << "map,width,height,algorithm,found,truncated,path_length,cost,nodes_expanded,time_ns,tile_lookups,tile_faults,"
+        << "hit_rate,evictions,prefetches,state_bytes,cache_bytes\n";
+    for (const TiledMeasurement& m : results) {
+        out << m.map << ',' << m.width << ',' << m.height << ',' << m.algorithm << ',' << (m.found ? 1 : 0) << ','
+            << (m.truncated ? 1 : 0) << ','
+            << m.pathLength << ',' << m.cost << ',' << m.expanded << ',' << m.timeNs << ',' << m.cache.lookups << ','
+            << m.cache.faults << ',' << m.cache.hitRate() << ',' << m.cache.evictions << ',' << m.cache.prefetches << ','
+            << m.stateBytes << ',' << m.cacheBytes << '\n';
+    }
+}
+
+void writeTiledJson(ostream& out, const vector<TiledMeasurement>& results) {
+    out << "[\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const TiledMeasurement& m = results[i];
+        out << "  {\"map\": \"" << jsonEscape(m.map) << "\", \"width\": " << m.width << ", \"height\": " << m.height
+            << ", \"algorithm\": \"" << m.algorithm << "\", \"found\": " << (m.found ? "true" : "false")
+            << ", \"truncated\": " << (m.truncated ? "true" : "false")
+            << ", \"path_length\": " << m.pathLength << ", \"cost\": " << m.cost << ", \"nodes_expanded\": " << m.expanded
+            << ", \"time_ns\": " << m.timeNs << ", \"tile_lookups\": " << m.cache.lookups
+            << ", \"tile_faults\": " << m.cache.faults << ", \"hit_rate\": " << m.cache.hitRate()
+            << ", \"evictions\": " << m.cache.evictions << ", \"prefetches\": " << m.cache.prefetches
+            << ", \"state_bytes\": " << m.stateBytes << ", \"cache_bytes\": " << m.cacheBytes << "}"
+            << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    out << "]\n";
+}
+
+// Built-in regression checks for --check. Each reports its failures and
+// returns false if there were any.
+
+// Searches that add up terrain costs; the others treat every open cell as 1.
+bool honoursCosts(Algorithm algo) {
+    return algo == Algorithm::AStar || algo == Algorithm::Dijkstra || algo == Algorithm::ALT || algo == Algorithm::FlowField;
+}
+
+// Cost of a path in 8-connected units, straight steps 70 and diagonal steps
+// 99 times the cost of the cell entered; -1 if the path is broken.
+int64_t pathCost(const Grid& grid, Point start, Point goal, const SearchResult& result) {
+    const vector<int>& path = result.path;
+    if (path.empty() || path.front() != grid.index(start.x, start.y) || path.back() != grid.index(goal.x, goal.y)) return -1;
+    int64_t cost = 0;
+    for (size_t i = 1; i < path.size(); ++i) {
+        Point a = grid.point(path[i - 1]), b = grid.point(path[i]);
+        if (abs(a.x - b.x) > 1 || abs(a.y - b.y) > 1 || path[i] == path[i - 1] || grid.isWall(path[i])) return -1;
+        cost += (a.x != b.x && a.y != b.y ? 99 : 70) * grid.cost(path[i]);
+    }
+    return cost;
+}
+
+// A goal on a tile edge must wake the tile across it, or everything past
+// that edge in a 1-cell-wide corridor stays unreachable.
+bool checkFlowFieldTileEdges() {
+    bool passed = true;
+    auto expect = [&](const string& name, const Grid& grid, Point start, Point goal) {
+        SearchResult reference = Pathfinder::findPath(Algorithm::Dijkstra, grid, start, goal);
+        SearchResult result = Pathfinder::findPath(Algorithm::FlowField, grid, start, goal);
+        if (result.found != reference.found || result.path.size() != reference.path.size()) {
+            cerr << "FAIL: " << name << " from (" << start.x << ',' << start.y << ") to (" << goal.x << ',' << goal.y
+                << "): FlowField " << (result.found ? to_string(result.path.size()) : "none") << " cells, Dijkstra "
+                << (reference.found ? to_string(reference.path.size()) : "none") << endl;
+            passed = false;
+        }
+    };
+
+    const int length = 3 * FlowField::kTileSize;
+    Grid row(length, 1), column(1, length);
+    for (int i = 0; i < length; ++i) {
+        if (i % FlowField::kTileSize != 0 && i % FlowField::kTileSize != FlowField::kTileSize - 1) continue;
+        for (int end : { 0, length - 1 }) {
+            expect("flowfield-row", row, { end, 0 }, { i, 0 });
+            expect("flowfield-column", column, { 0, end }, { 0, i });
+        }
+    }
+    return passed;
+}
+
+// Every search that promises shortest paths must match Dijkstra's cost on
+// small seeded maps: 4-way on uniform maps, 8-way for the searches that move
+// diagonally, and 4-way over terrain for the searches that add up costs.
+bool checkOptimalPaths() {
+    struct Mode {
+        const char* name;
+        Connectivity moves;
+        bool terrain;
+    };
+    const Mode modes[] = { { "4way", Connectivity::Four, false }, { "8way", Connectivity::Eight, false }, { "weighted", Connectivity::Four, true } };
+    Options all;
+
+    bool passed = true;
+    int queries = 0;
+    for (const Mode& mode : modes) {
+        for (int seed = 0; seed < 24; ++seed) {
+            mt19937_64 rng(seed);
+            int width = 4 + static_cast<int>(rng() % 90), height = 4 + static_cast<int>(rng() % 90);
+            Grid grid(width, height);
+            if (seed % 3 == 2) MazeGenerator::generateMaze(grid, static_cast<MazeAlgorithm>(seed % 5), seed, 0.3);
+            else MazeGenerator::generateRandomWalls(grid, 0.1 * (seed % 4), seed);
+            if (mode.terrain) MazeGenerator::generateTerrain(grid, Grid::kMaxCost, seed);
+
+            for (int q = 0; q < 6; ++q) {
+                Point start{ static_cast<int>(rng() % width), static_cast<int>(rng() % height) };
+                Point goal{ static_cast<int>(rng() % width), static_cast<int>(rng() % height) };
+                grid.setWall(start.x, start.y, false);
+                grid.setWall(goal.x, goal.y, false);
+                SearchResult reference = Pathfinder::findPath(Algorithm::Dijkstra, grid, start, goal, mode.moves);
+                int64_t best = reference.found ? pathCost(grid, start, goal, reference) : -1;
+
+                for (Algorithm algo : all.algorithms) {
+                    if (!isOptimal(algo) || algo == Algorithm::Dijkstra) continue;
+                    if (mode.moves == Connectivity::Eight && !movesDiagonally(algo)) continue;
+                    if (mode.terrain && !honoursCosts(algo)) continue;
+                    ++queries;
+                    SearchResult result = Pathfinder::findPath(algo, grid, start, goal, mode.moves);
+                    int64_t cost = result.found ? pathCost(grid, start, goal, result) : -1;
+                    if (result.found == reference.found && cost == best) continue;
+                    cerr << "FAIL: " << algorithmName(algo) << ' ' << mode.name << " seed " << seed << " from (" << start.x << ','
+                        << start.y << ") to (" << goal.x << ',' << goal.y << "): cost " << cost << ", Dijkstra " << best << endl;
+                    passed = false;
+                }
+            }
+        }
+    }
+    cerr << "Compared " << queries << " optimal paths with Dijkstra" << endl;
+    return passed;
+}
+
+// The shared component index must agree with a freshly built one while
+// queries alternate between an edited copy of a grid, which the index
+// catches up with, and four other grids. That is more grids than the cache
+// keeps, so entries are also evicted and rebuilt along the way.
+bool checkSharedComponents() {
+    vector<Grid> grids;
+    for (int seed = 0; seed < 4; ++seed) {
+        grids.emplace_back(96, 64);
+        MazeGenerator::generateRandomWalls(grids.back(), 0.4, seed);
+    }
+    grids.push_back(grids[0]);
+    Grid& edited = grids.back();
+
+    bool passed = true;
+    mt19937_64 rng(1);
+    for (int round = 0; round < 60; ++round) {
+        // Walls and openings both, so the index has to split and merge.
+        for (int edit = 0; edit < 8; ++edit) {
+            int cell = static_cast<int>(rng() % edited.cellCount());
+            Point p = edited.point(cell);
+            edited.setWall(p.x, p.y, !edited.isWall(cell));
+        }
+        int which = round % 2 ? 4 : round / 2 % 4;
+        const Grid& grid = grids[which];
+        shared_ptr<const ComponentIndex> cached = ComponentIndex::shared(grid);
+        ComponentIndex fresh(grid);
+        for (int q = 0; q < 200; ++q) {
+            int a = static_cast<int>(rng() % grid.cellCount()), b = static_cast<int>(rng() % grid.cellCount());
+            if (cached->connected(a, b) == fresh.connected(a, b)) continue;
+            cerr << "FAIL: shared component index on grid " << which << " in round " << round << " says cells "
+                << a << " and " << b << (fresh.connected(a, b) ? " are not" : " are") << " connected" << endl;
+            passed = false;
+            break;
+        }
+    }
+    return passed;
+}
+
+// Run 8-way, ALT is plain octile A* and its landmarks go unchecked, so
+// scenario suites must run it 4-way. On an open map its path then has no
+// diagonal steps.
+bool checkScenarioAlt() {
+    Grid grid(32, 32);
+    SearchResult result = Pathfinder::findPath(Algorithm::ALT, grid, { 0, 0 }, { 31, 31 }, scenarioMoves(Algorithm::ALT));
+    if (!movesDiagonally(Algorithm::ALT) && result.found && result.path.size() == 63) return true;
+    cerr << "FAIL: scenario suites run ALT with diagonal moves (" << result.path.size() << "-cell path on an open 32x32 map)" << endl;
+    return false;
+}
+
+bool runChecks() {
+    bool passed = checkFlowFieldTileEdges();
+    passed &= checkOptimalPaths();
+    passed &= checkSharedComponents();
+    passed &= checkScenarioAlt();
+    return passed;
+}
+
+// Opens --out, or returns false after reporting why not.
+bool openOutput(const Options& options, ofstream& file) {
+    if (options.output.empty()) return true;
+    file.open(options.output);
+    if (!file) {
+        cerr << "Cannot write " << options.output << endl;
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) return EXIT_FAILURE;
+    // Keeps landmark tables between runs, so repeated runs on a corpus time
+    // ALT's searches rather than its table builds.
+    LandmarkTable::setCacheDirectory(".pathfinding-cache");
+    if (options.format != "csv" && options.format != "json") {
+        cerr << "Unknown format: " << options.format << endl;
+        return EXIT_FAILURE;
+    }
+
+    if (options.check) {
+        bool passed = runChecks();
+        cerr << (passed ? "All checks passed" : "Checks failed") << endl;
+        return passed ? 0 : EXIT_FAILURE;
+    }
+
+    if (!options.scenFiles.empty()) {
+        vector<BucketResult> results;
+        bool passed;
+        try {
+            passed = runScenarios(options, results);
+        }
+        catch (const exception& e) {
+            cerr << e.what() << endl;
+            return EXIT_FAILURE;
+        }
+
+        ofstream file;
+        if (!openOutput(options, file)) return EXIT_FAILURE;
+        ostream& out = options.output.empty() ? cout : file;
+        if (options.format == "json") writeScenarioJson(out, results);
+        else writeScenarioCsv(out, results);
+        return passed ? 0 : EXIT_FAILURE;
+    }
+
+    if (!options.makeTiled.empty()) options.tiledFiles.insert(options.tiledFiles.begin(), options.makeTiled);
+    if (!options.tiledFiles.empty()) {
+        vector<TiledMeasurement> results;
+        try {
+            if (!options.makeTiled.empty()) {
+                int size = options.sizes.empty() ? 1024 : options.sizes.front();
+                double density = options.densities.empty() ? 0.2 : options.densities.front();
+                cerr << "Writing " << options.makeTiled << endl;
+                MazeGenerator::writeTiledRandomWalls(options.makeTiled, size, size, density, 0);
+            }
+            runTiledMaps(options, results);
+        }
+        catch (const exception& e) {
+            cerr << e.what() << endl;
+            return EXIT_FAILURE;
+        }
+
+        ofstream file;
+        if (!openOutput(options, file)) return EXIT_FAILURE;
+        ostream& out = options.output.empty() ? cout : file;
+        if (options.format == "json") writeTiledJson(out, results);
+        else writeTiledCsv(out, results);
+        return 0;
+    }
+
+    vector<MapCase> corpus;
+    try {
+        corpus = buildCorpus(options);
+    }
+    catch (const exception& e) {
+        cerr << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    ThreadPool pool(options.batch > 0 ? options.threads : 1);
+    BatchSearch batch(pool);
+
+    vector<Measurement> results;
+    for (const MapCase& map : corpus) {
+        vector<Query> queries = makeQueries(map, options.batch);
+        for (Algorithm algo : options.algorithms) {
+            cerr << map.name << " / " << algorithmName(algo) << endl;
+            results.push_back(measure(map, algo, options));
+            if (!queries.empty()) results.back().batchQps = measureBatch(map, algo, batch, queries, options.moves);
+        }
+        for (int budgetUs : options.anytimeBudgetsUs) {
+            cerr << map.name << " / ARAStar@" << budgetUs << "us" << endl;
+            results.push_back(measureAnytime(map, budgetUs, options));
+        }
+    }
+
+    ofstream file;
+    if (!openOutput(options, file)) return EXIT_FAILURE;
+    ostream& out = options.output.empty() ? cout : file;
+    if (options.format == "json") writeJson(out, results);
+    else writeCsv(out, results);
+    return 0;
+}
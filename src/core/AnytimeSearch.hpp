@@ -0,0 +1,339 @@
+#pragma once
+
+#include "ComponentIndex.hpp"
+#include "Grid.hpp"
+#include "SearchArena.hpp"
+#include "SearchKernel.hpp"
+#include "SearchObserver.hpp"
+#include "SearchResult.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <vector>
+
+namespace Pathfinding {
+
+// How long one AnytimePlanner::plan call may run: until a deadline, after a
+// number of expansions, or whichever comes first.
+struct AnytimeBudget {
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+    std::size_t expansions = std::numeric_limits<std::size_t>::max();
+
+    static AnytimeBudget within(std::chrono::nanoseconds time) {
+        AnytimeBudget budget;
+        budget.deadline = std::chrono::steady_clock::now() + time;
+        return budget;
+    }
+};
+
+struct AnytimeResult : SearchResult {
+    int cost = 0;        // path cost in the neighbourhood's step units
+    // The path costs at most bound times the optimal cost; 1 once it is proven
+    // optimal, and infinity while no search round has finished.
+    double bound = std::numeric_limits<double>::infinity();
+    int rounds = 0;      // search rounds finished so far, one per epsilon
+};
+
+// Anytime Repairing A* (ARA*): a weighted A* that orders cells by g + eps * h,
+// which reaches the goal quickly with a path at most eps times optimal, then
+// lowers eps and repairs the search instead of restarting it. Cells whose cost
+// improved after they were expanded are set aside and requeued at the start of
+// the next round, so each round only reprocesses what the smaller eps changes.
+//
+// plan() runs rounds until the path is proven optimal or the budget runs out,
+// and returns the best path so far with its suboptimality bound. The deadline
+// is checked every 64 expansions. Calling plan() again for the same grid,
+// start and goal carries on from where the last call stopped, so a real-time
+// caller can spread one query over several frames. Any other query starts
+// afresh. One planner serves one caller; it is not safe to share between
+// threads.
+template <class Moves, class Heuristic>
+class AnytimePlanner {
+public:
+    // The first round searches with initialEpsilon. Each later round takes the
+    // smaller of the last eps and the bound it proved, and keeps `decay` of
+    // its excess over 1; once that excess falls below 1/64, the round is
+    // plain A*. Bounds often come out far below eps, so stepping down from
+    // the bound rather than by a fixed amount keeps the rounds gradual.
+    explicit AnytimePlanner(double initialEpsilon = 3.0, double decay = 0.5, const Heuristic& heuristic = Heuristic())
+        : initialEpsilon_(std::max(1.0, initialEpsilon)), decay_(std::max(0.0, std::min(decay, 0.99))), heuristic_(heuristic) {}
+
+    template <class Observer>
+    AnytimeResult plan(const Grid& grid, int start, int end, const AnytimeBudget& budget, Observer& observer) {
+        return plan(grid, start, end, budget, observer, [](const AnytimeResult&) {});
+    }
+
+    // Also calls onSolution(result) with the path and bound after every
+    // finished round.
+    template <class Observer, class OnSolution>
+    AnytimeResult plan(const Grid& grid, int start, int end, const AnytimeBudget& budget, Observer& observer,
+        OnSolution&& onSolution) {
+        observer.onPhase(SearchPhase::Setup);
+        if (!sameQuery(grid, start, end)) {
+            begin(grid, start, end);
+            if (!connected_) {
+                observer.onPhase(SearchPhase::Done);
+                return {};
+            }
+        }
+        observer.onPhase(SearchPhase::Search);
+
+        std::size_t expanded = 0;
+        while (bound_ > 1.0) {
+            if (roundFinished_) {
+                if (std::chrono::steady_clock::now() >= budget.deadline) break;
+                beginRound(grid);
+            }
+            if (!improvePath(grid, budget, expanded, observer)) break;
+            finishRound(grid);
+            onSolution(current(grid));
+        }
+
+        observer.onPhase(SearchPhase::Reconstruct);
+        AnytimeResult result = current(grid);
+        for (auto cell = result.path.rbegin(); cell != result.path.rend(); ++cell) observer.onPath(*cell);
+        observer.onPhase(SearchPhase::Done);
+        return result;
+    }
+
+    // Forgets all state; the next plan() searches from scratch.
+    void invalidate() { gridId_ = 0; }
+
+private:
+    // Epsilon is fixed point in 1/kScale steps, so keys stay exact integers.
+    static constexpr std::int64_t kScale = 1024;
+
+    struct Entry {
+        std::int64_t key;  // g * kScale + eps * h
+        int g;
+        int index;
+
+        // Ties on key go to the larger g, the deeper node.
+        bool operator>(const Entry& other) const {
+            if (key != other.key) return key > other.key;
+            if (g != other.g) return g < other.g;
+            return index > other.index;
+        }
+    };
+
+    bool sameQuery(const Grid& grid, int start, int end) const {
+        return grid.id() == gridId_ && grid.version() == version_ && start == start_ && end == goal_;
+    }
+
+    void begin(const Grid& grid, int start, int end) {
+        gridId_ = grid.id();
+        version_ = grid.version();
+        start_ = start;
+        goal_ = end;
+        connected_ = ComponentIndex::shared(grid)->connected(start, end);
+        bound_ = std::numeric_limits<double>::infinity();
+        rounds_ = 0;
+        roundFinished_ = false;
+        bestPath_.clear();
+        heap_.clear();
+        incons_.clear();
+        if (!connected_) return;
+
+        arena_.begin(grid.cellCount());
+        if (closed_.size() < static_cast<std::size_t>(grid.cellCount())) {
+            closed_.assign(grid.cellCount(), 0);
+            inconsistent_.assign(grid.cellCount(), 0);
+        }
+        round_ = nextStamp();
+        epsilon_ = static_cast<std::int64_t>(initialEpsilon_ * kScale + 0.5);
+        lowerBound_ = 0;
+
+        arena_.reach(start, 0, -1);
+        // As in SearchKernel, the start goes in without a visit event;
+        // StatsObserver counts it as the first push.
+        enqueue(grid, start, 0);
+    }
+
+    // Stamps mark a cell closed, or set aside as inconsistent, in one round.
+    // Every round of every query takes a fresh one, so nothing is cleared
+    // between rounds.
+    std::uint32_t nextStamp() {
+        if (++stamp_ == 0) {
+            std::fill(closed_.begin(), closed_.end(), 0);
+            std::fill(inconsistent_.begin(), inconsistent_.end(), 0);
+            stamp_ = 1;
+        }
+        return stamp_;
+    }
+
+    int h(const Grid& grid, int cell) const { return heuristic_.template between<Moves>(grid, cell, goal_); }
+
+    void enqueue(const Grid& grid, int cell, int g) {
+        heap_.push_back({ g * kScale + epsilon_ * h(grid, cell), g, cell });
+        std::push_heap(heap_.begin(), heap_.end(), std::greater<Entry>());
+    }
+
+    template <class Observer>
+    void push(const Grid& grid, int cell, int g, Observer& observer) {
+        enqueue(grid, cell, g);
+        observer.onVisit(cell);
+        if constexpr (Observer::enabled) observer.onOpenSize(heap_.size());
+    }
+
+    // An entry is live if it carries its cell's current cost and the cell has
+    // not been expanded this round; improved cells always get a new entry.
+    bool live(const Entry& entry) const { return entry.g == arena_.cost(entry.index) && closed_[entry.index] != round_; }
+
+    bool outOfTime(const AnytimeBudget& budget, std::size_t expanded) const {
+        if (expanded >= budget.expansions) return true;
+        return expanded % 64 == 0 && std::chrono::steady_clock::now() >= budget.deadline;
+    }
+
+    // Expands cells in key order until none can improve the goal under the
+    // current eps. Returns false if the budget ran out first.
+    template <class Observer>
+    bool improvePath(const Grid& grid, const AnytimeBudget& budget, std::size_t& expanded, Observer& observer) {
+        while (!heap_.empty()) {
+            const Entry& top = heap_.front();
+            if (!live(top)) {
+                observer.onPop(top.index);
+                observer.onStale(top.index);
+                std::pop_heap(heap_.begin(), heap_.end(), std::greater<Entry>());
+                heap_.pop_back();
+                continue;
+            }
+            int goalCost = arena_.cost(goal_);
+            if (goalCost != SearchArena::kUnreached && goalCost * kScale <= top.key) return true;
+            if (outOfTime(budget, expanded)) return false;
+
+            Entry entry = top;
+            std::pop_heap(heap_.begin(), heap_.end(), std::greater<Entry>());
+            heap_.pop_back();
+            observer.onPop(entry.index);
+            observer.onExpand(entry.index);
+            closed_[entry.index] = round_;
+            ++expanded;
+
+            Neighbours<Moves>::forEach(grid, entry.index, [&](int next, int unit) {
+                observer.onGenerate(next);
+                int tentative = entry.g + unit * grid.cost(next);
+                if (tentative >= arena_.cost(next)) return;
+                arena_.reach(next, tentative, entry.index);
+                if (closed_[next] != round_) push(grid, next, tentative, observer);
+                else if (inconsistent_[next] != round_) {
+                    // Expanded already this round: wait for the next one.
+                    inconsistent_[next] = round_;
+                    incons_.push_back(next);
+                }
+                });
+        }
+        return true;
+    }
+
+    // Ends a round. The cheapest g + h over the open and set-aside cells
+    // bounds the optimal cost from below, which can prove the path closer to
+    // optimal than eps promised.
+    void finishRound(const Grid& grid) {
+        ++rounds_;
+        roundFinished_ = true;
+        int goalCost = arena_.cost(goal_);
+        if (goalCost == SearchArena::kUnreached) {
+            // Nothing left to search: the goal is unreachable after all.
+            bound_ = 1.0;
+            return;
+        }
+        std::int64_t lowest = goalCost;
+        for (const Entry& entry : heap_) {
+            if (live(entry)) lowest = std::min<std::int64_t>(lowest, entry.g + h(grid, entry.index));
+        }
+        for (int cell : incons_) lowest = std::min<std::int64_t>(lowest, arena_.cost(cell) + h(grid, cell));
+        lowerBound_ = std::max(lowerBound_, lowest);
+        keepBest(grid);
+        bound_ = std::min(double(epsilon_) / kScale, proven(bestCost_));
+    }
+
+    double proven(int cost) const { return lowerBound_ > 0 ? std::max(1.0, double(cost) / double(lowerBound_)) : 1.0; }
+
+    // Cost of the path along the parents from the goal. A cell's parent may
+    // have improved since it was set, so this can be less than the goal's g;
+    // it can also rise when a cell on the path switches to a cheaper parent
+    // whose own path is longer, which is why the best path is kept apart.
+    int pathCost(const Grid& grid) const {
+        int cost = 0;
+        for (int cell = goal_; cell != start_; cell = arena_.parent(cell)) {
+            int parent = arena_.parent(cell), w = grid.width();
+            bool diagonal = cell % w != parent % w && cell / w != parent / w;
+            cost += (diagonal ? Moves::kDiagonal : Moves::kStraight) * grid.cost(cell);
+        }
+        return cost;
+    }
+
+    // Lowers eps, then rebuilds the open list from its live entries and the
+    // set-aside cells, keyed with the new eps.
+    void beginRound(const Grid& grid) {
+        std::int64_t excess = std::min(epsilon_, static_cast<std::int64_t>(bound_ * kScale)) - kScale;
+        excess = static_cast<std::int64_t>(excess * decay_);
+        epsilon_ = excess < kScale / 64 ? kScale : kScale + excess;
+
+        std::vector<Entry> open;
+        open.reserve(heap_.size() + incons_.size());
+        for (const Entry& entry : heap_) {
+            if (live(entry)) open.push_back({ entry.g * kScale + epsilon_ * h(grid, entry.index), entry.g, entry.index });
+        }
+        for (int cell : incons_) {
+            int g = arena_.cost(cell);
+            open.push_back({ g * kScale + epsilon_ * h(grid, cell), g, cell });
+        }
+        std::make_heap(open.begin(), open.end(), std::greater<Entry>());
+        heap_.swap(open);
+        incons_.clear();
+        round_ = nextStamp();
+        roundFinished_ = false;
+    }
+
+    void keepBest(const Grid& grid) {
+        if (arena_.cost(goal_) == SearchArena::kUnreached) return;
+        int cost = pathCost(grid);
+        if (!bestPath_.empty() && cost >= bestCost_) return;
+        bestCost_ = cost;
+        bestPath_.clear();
+        for (int cell = goal_; cell != start_; cell = arena_.parent(cell)) bestPath_.push_back(cell);
+        bestPath_.push_back(start_);
+        std::reverse(bestPath_.begin(), bestPath_.end());
+    }
+
+    // The best path so far; mid-round it may already beat the last round's.
+    AnytimeResult current(const Grid& grid) {
+        keepBest(grid);
+        AnytimeResult result;
+        result.rounds = rounds_;
+        if (bestPath_.empty()) return result;
+
+        result.found = true;
+        result.path = bestPath_;
+        result.cost = bestCost_;
+        if (rounds_ > 0) result.bound = std::min(bound_, proven(bestCost_));
+        return result;
+    }
+
+    double initialEpsilon_, decay_;
+    Heuristic heuristic_;
+
+    std::uint64_t gridId_ = 0, version_ = 0;
+    int start_ = -1, goal_ = -1;
+    bool connected_ = false;
+
+    SearchArena arena_;                     // g and parent per cell, for this query
+    std::vector<Entry> heap_;               // open list, lazily pruned
+    std::vector<int> incons_;               // improved after expansion this round
+    std::vector<int> bestPath_;             // cheapest path seen, start to goal
+    int bestCost_ = 0;
+    std::vector<std::uint32_t> closed_, inconsistent_;
+    std::uint32_t stamp_ = 0, round_ = 0;
+    std::int64_t epsilon_ = kScale;
+    std::int64_t lowerBound_ = 0;           // largest proven lower bound on the optimal cost
+    double bound_ = std::numeric_limits<double>::infinity();
+    int rounds_ = 0;
+    bool roundFinished_ = false;            // the next plan() call lowers eps first
+};
+
+} // namespace Pathfinding
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "ComponentIndex.hpp"
+#include "FlowField.hpp"
+#include "Grid.hpp"
+#include "Pathfinder.hpp"
+#include "SearchArena.hpp"
+#include "SearchObserver.hpp"
+#include "SearchResult.hpp"
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace Pathfinding {
+
+struct Query {
+    Point start, end;
+};
+
+// Solves many queries against one read-only grid in parallel. Every pool worker
+// owns a SearchArena that persists across calls, so once the arenas are warm
+// the searches themselves do not allocate; only the returned paths do.
+class BatchSearch {
+public:
+    explicit BatchSearch(ThreadPool& pool) : pool_(pool), arenas_(pool.size()) {}
+
+    // results must have room for count entries; results[i] answers queries[i].
+    void run(Algorithm algo, const Grid& grid, const Query* queries, std::size_t count, SearchResult* results,
+        Connectivity moves = Connectivity::Four) {
+        if (algo == Algorithm::FlowField) {
+            runFlowFields(grid, queries, count, results);
+            return;
+        }
+        // Taken once here rather than per query, so workers never contend for
+        // the shared index's lock.
+        std::shared_ptr<const ComponentIndex> components = ComponentIndex::shared(grid);
+        pool_.parallelFor(count, [&](std::size_t i, unsigned worker) {
+            NullObserver observer;
+            results[i] = Pathfinder::findPath(algo, grid, queries[i].start, queries[i].end, observer, arenas_[worker], *components, moves);
+            });
+    }
+
+    std::vector<SearchResult> run(Algorithm algo, const Grid& grid, const std::vector<Query>& queries,
+        Connectivity moves = Connectivity::Four) {
+        std::vector<SearchResult> results(queries.size());
+        run(algo, grid, queries.data(), queries.size(), results.data(), moves);
+        return results;
+    }
+
+private:
+    // Flow-field queries are grouped by goal rather than sent through the
+    // shared field, which keeps one field at a time. A single goal builds its
+    // field across the pool; several goals are built one per worker, each
+    // answering its own queries and then dropped, so at most one field per
+    // worker is held at once.
+    void runFlowFields(const Grid& grid, const Query* queries, std::size_t count, SearchResult* results) {
+        std::vector<std::pair<int, std::size_t>> byGoal; // goal cell, query
+        for (std::size_t i = 0; i < count; ++i) {
+            const Query& q = queries[i];
+            results[i] = {};
+            if (grid.inBounds(q.start.x, q.start.y) && grid.inBounds(q.end.x, q.end.y)) byGoal.push_back({ grid.index(q.end.x, q.end.y), i });
+        }
+        std::sort(byGoal.begin(), byGoal.end());
+        std::vector<std::size_t> groups; // first entry of each goal in byGoal
+        for (std::size_t k = 0; k < byGoal.size(); ++k) {
+            if (k == 0 || byGoal[k].first != byGoal[k - 1].first) groups.push_back(k);
+        }
+        groups.push_back(byGoal.size());
+        auto answer = [&](const FlowField& field, std::size_t k) {
+            const Query& q = queries[byGoal[k].second];
+            results[byGoal[k].second] = field.path(grid, grid.index(q.start.x, q.start.y));
+        };
+
+        if (groups.size() == 2) {
+            FlowField field(grid, byGoal.front().first, &pool_);
+            pool_.parallelFor(byGoal.size(), [&](std::size_t k, unsigned) { answer(field, k); });
+            return;
+        }
+        pool_.parallelFor(groups.size() - 1, [&](std::size_t g, unsigned) {
+            FlowField field(grid, byGoal[groups[g]].first);
+            for (std::size_t k = groups[g]; k < groups[g + 1]; ++k) answer(field, k);
+            });
+    }
+
+    ThreadPool& pool_;
+    std::vector<SearchArena> arenas_;
+};
+
+} // namespace Pathfinding
@@ -0,0 +1,239 @@
+#pragma once
+
+#include "Grid.hpp"
+#include "SearchObserver.hpp"
+#include "SearchResult.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace Pathfinding {
+
+// Searches from start and end at the same time, one direction per thread.
+//
+// Each side publishes its distance labels in an array of atomics that only it
+// writes. A side stores its own label and then reads the other side's label for
+// the same cell, and the other side does the same in reverse. With
+// sequentially consistent accesses, at least one of the two sees both labels,
+// so every meeting cell is reported without a lock. The best meeting cost is
+// kept in a single atomic word together with its cell.
+//
+// Both variants stop only once no undiscovered path can beat the best meeting,
+// so their paths are optimal:
+//   BFS: sides expand whole layers and stop once best <= radiusStart + radiusEnd + 1.
+//   A*:  each side runs A* toward the other endpoint and stops when its smallest
+//        f reaches the best meeting cost.
+class BidirectionalSearch {
+public:
+    template <class Observer>
+    static SearchResult bfs(const Grid& grid, int start, int end, Observer& observer) {
+        return run<false>(grid, start, end, observer);
+    }
+
+    template <class Observer>
+    static SearchResult aStar(const Grid& grid, int start, int end, Observer& observer) {
+        return run<true>(grid, start, end, observer);
+    }
+
+private:
+    static constexpr std::uint64_t kNoMeeting = std::numeric_limits<std::uint64_t>::max();
+
+    struct Shared {
+        // label[side][cell] is the side's distance to the cell plus one; zero means unreached.
+        std::vector<std::atomic<int>> label[2];
+        std::atomic<std::uint64_t> best{ kNoMeeting }; // cost << 32 | meeting cell
+        std::atomic<int> radius[2] = { {0}, {0} };    // BFS: every cell this close is labelled
+        std::atomic<bool> stop{ false };
+
+        explicit Shared(int cells) : label{ std::vector<std::atomic<int>>(cells), std::vector<std::atomic<int>>(cells) } {}
+
+        int bestCost() const {
+            std::uint64_t packed = best.load();
+            return packed == kNoMeeting ? std::numeric_limits<int>::max() : static_cast<int>(packed >> 32);
+        }
+
+        void offer(int cost, int cell) {
+            std::uint64_t candidate = (std::uint64_t(cost) << 32) | std::uint32_t(cell);
+            std::uint64_t current = best.load();
+            while (candidate < current && !best.compare_exchange_weak(current, candidate)) {}
+        }
+    };
+
+    // Observer events are buffered per side and replayed on the calling thread
+    // after the search, interleaving the two sides, so observers never see
+    // concurrent calls. With a disabled observer nothing is recorded.
+    struct Event {
+        bool expand;
+        int index;
+    };
+
+    struct Side {
+        const Grid& grid;
+        Shared& shared;
+        int id;
+        int origin, target;
+        std::vector<int> parent;
+        std::vector<Event> events;
+
+        Side(const Grid& grid, Shared& shared, int id, int origin, int target)
+            : grid(grid), shared(shared), id(id), origin(origin), target(target), parent(grid.cellCount(), -1) {}
+
+        std::vector<std::atomic<int>>& mine() { return shared.label[id]; }
+        std::vector<std::atomic<int>>& theirs() { return shared.label[1 - id]; }
+
+        template <bool Record>
+        void record(bool expand, int index) {
+            if constexpr (Record) events.push_back({ expand, index });
+        }
+
+        // Labels cell with distance g, then checks whether the other side has been there.
+        void label(int cell, int from, int g) {
+            mine()[cell].store(g + 1);
+            parent[cell] = from;
+            int other = theirs()[cell].load();
+            if (other != 0) shared.offer(g + other - 1, cell);
+        }
+
+        template <bool Record>
+        void runBfs() {
+            std::vector<int> frontier = { origin }, next;
+            for (int depth = 0; !shared.stop.load(std::memory_order_relaxed); ++depth) {
+                int best = shared.bestCost();
+                int reach = shared.radius[id].load(std::memory_order_acquire) + shared.radius[1 - id].load(std::memory_order_acquire);
+                if (frontier.empty() || (best != std::numeric_limits<int>::max() && best <= reach + 1)) break;
+
+                next.clear();
+                for (int current : frontier) {
+                    record<Record>(true, current);
+                    forEachNeighbour(grid, current, [&](int neighbour) {
+                        if (mine()[neighbour].load(std::memory_order_relaxed) != 0) return;
+                        label(neighbour, current, depth + 1);
+                        next.push_back(neighbour);
+                        record<Record>(false, neighbour);
+                        });
+                }
+                frontier.swap(next);
+                shared.radius[id].store(depth + 1, std::memory_order_release);
+            }
+            shared.stop.store(true);
+        }
+
+        struct Node {
+            int index;
+            int g, h;
+
+            bool operator>(const Node& other) const {
+                return g + h != other.g + other.h ? g + h > other.g + other.h : g < other.g;
+            }
+        };
+
+        template <bool Record>
+        void runAStar() {
+            std::priority_queue<Node, std::vector<Node>, std::greater<Node>> openSet;
+            openSet.push({ origin, 0, manhattan(grid, origin, target) });
+
+            while (!shared.stop.load(std::memory_order_relaxed)) {
+                // Drop stale entries so the top is this side's true minimum f.
+                while (!openSet.empty() && openSet.top().g + 1 > mine()[openSet.top().index].load(std::memory_order_relaxed)) {
+                    openSet.pop();
+                }
+                if (openSet.empty()) break;
+
+                Node current = openSet.top();
+                if (current.g + current.h >= shared.bestCost()) break;
+                openSet.pop();
+                record<Record>(true, current.index);
+
+                forEachNeighbour(grid, current.index, [&](int neighbour) {
+                    int g = current.g + 1;
+                    int known = mine()[neighbour].load(std::memory_order_relaxed);
+                    if (known != 0 && known <= g + 1) return;
+                    label(neighbour, current.index, g);
+                    openSet.push({ neighbour, g, manhattan(grid, neighbour, target) });
+                    record<Record>(false, neighbour);
+                    });
+            }
+            shared.stop.store(true);
+        }
+
+        template <bool Heuristic, bool Record>
+        void search() {
+            if constexpr (Heuristic) runAStar<Record>();
+            else runBfs<Record>();
+        }
+    };
+
+    template <bool Heuristic, class Observer>
+    static SearchResult run(const Grid& grid, int start, int end, Observer& observer) {
+        if (start == end) {
+            SearchResult result;
+            result.found = true;
+            result.path.push_back(start);
+            return result;
+        }
+
+        Shared shared(grid.cellCount());
+        Side forward(grid, shared, 0, start, end);
+        Side backward(grid, shared, 1, end, start);
+        // Both origins are labelled before either thread starts, so each side
+        // finds the other's origin as a meeting cell when it gets there.
+        shared.label[0][start].store(1);
+        shared.label[1][end].store(1);
+
+        constexpr bool record = Observer::enabled;
+        std::thread worker([&]() { backward.template search<Heuristic, record>(); });
+        forward.template search<Heuristic, record>();
+        worker.join();
+
+        if constexpr (record) replay(forward.events, backward.events, observer);
+
+        std::uint64_t best = shared.best.load();
+        if (best == kNoMeeting) return {};
+
+        int meet = static_cast<int>(best & 0xffffffffu);
+        SearchResult result;
+        result.found = true;
+        for (int cell = meet; cell != -1; cell = forward.parent[cell]) result.path.push_back(cell);
+        std::reverse(result.path.begin(), result.path.end());
+        for (int cell = backward.parent[meet]; cell != -1; cell = backward.parent[cell]) result.path.push_back(cell);
+
+        for (auto it = result.path.rbegin(); it != result.path.rend() - 1; ++it) observer.onPath(*it);
+        return result;
+    }
+
+    template <class Observer>
+    static void replay(const std::vector<Event>& a, const std::vector<Event>& b, Observer& observer) {
+        for (size_t i = 0; i < std::max(a.size(), b.size()); ++i) {
+            for (const std::vector<Event>* events : { &a, &b }) {
+                if (i >= events->size()) continue;
+                const Event& event = (*events)[i];
+                if (event.expand) observer.onExpand(event.index);
+                else observer.onVisit(event.index);
+            }
+        }
+    }
+
+    template <class Fn>
+    static void forEachNeighbour(const Grid& grid, int index, Fn&& fn) {
+        int w = grid.width();
+        int x = index % w, y = index / w;
+        if (x > 0 && !grid.isWall(x - 1, y)) fn(index - 1);
+        if (y > 0 && !grid.isWall(x, y - 1)) fn(index - w);
+        if (y + 1 < grid.height() && !grid.isWall(x, y + 1)) fn(index + w);
+        if (x + 1 < w && !grid.isWall(x + 1, y)) fn(index + 1);
+    }
+
+    static int manhattan(const Grid& grid, int a, int b) {
+        int w = grid.width();
+        return std::abs(a % w - b % w) + std::abs(a / w - b / w);
+    }
+};
+
+} // namespace Pathfinding
@@ -0,0 +1,322 @@
+#pragma once
+
+#include "Grid.hpp"
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace Pathfinding {
+
+// Labels every open cell with its 4-connected component, so a query whose
+// endpoints lie in different components can be rejected without searching.
+//
+// The index is built with a lock-free union-find. Rows are split across a
+// thread pool, and each thread links cells to their left and upper neighbours
+// with compare-and-swap on a shared parent array. After that, cells carry
+// component ids, and the ids form a second, small union-find:
+//   - Opening a cell gives it a fresh id and unions that id with its neighbours'.
+//   - Walling a cell may cut its component in two. Floods from the cell's
+//     neighbours run in lockstep until they meet. A flood that runs out first
+//     has covered a piece that is now cut off, and only that piece is relabelled.
+// The work per edit is therefore bounded by the smaller side of any cut.
+class ComponentIndex {
+public:
+    explicit ComponentIndex(const Grid& grid, ThreadPool* pool = nullptr) { rebuild(grid, pool); }
+
+    // False only when both cells are open and lie in different components.
+    // A walled endpoint is left for the search to judge.
+    bool connected(int a, int b) const {
+        int la = label_[a], lb = label_[b];
+        if (la < 0 || lb < 0) return true;
+        return root(la) == root(lb);
+    }
+
+    // Component of an open cell, -1 for walls. Equal values mean connected.
+    int component(int cell) const { return label_[cell] < 0 ? -1 : root(label_[cell]); }
+
+    // Catches up with wall edits made since the index was built or last
+    // updated, rebuilding only when the grid's journal cannot say what changed.
+    void update(const Grid& grid, ThreadPool* pool = nullptr) {
+        if (grid.id() == gridId_ && grid.version() == version_) return;
+
+        std::vector<int> changed;
+        if (grid.id() != gridId_ || !grid.changesSince(version_, changed) || ids_.size() > 2 * label_.size() + 64) {
+            rebuild(grid, pool);
+            return;
+        }
+        std::sort(changed.begin(), changed.end());
+        changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+
+        // Removals first, judged against the labels rather than the grid, so
+        // each cut is checked while the cells not yet processed still count as
+        // open. Openings then only ever merge.
+        for (int cell : changed) {
+            if (label_[cell] >= 0 && grid.isWall(cell)) close(cell);
+        }
+        for (int cell : changed) {
+            if (label_[cell] < 0 && !grid.isWall(cell)) open(cell);
+        }
+        version_ = grid.version();
+    }
+
+    // Index for the grid's current contents, shared by every thread and kept
+    // current with update(). One index is kept per grid, for the few grids used
+    // most recently, so callers alternating between grids do not rebuild on
+    // every switch. As with HierarchicalMap, an index still held by another
+    // caller is copied before it changes.
+    static std::shared_ptr<const ComponentIndex> shared(const Grid& grid) {
+        static std::mutex mutex;
+        static std::vector<std::pair<std::uint64_t, std::shared_ptr<ComponentIndex>>> cached; // last use, index
+        static std::uint64_t uses = 0;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        ++uses;
+        for (auto& [used, index] : cached) {
+            if (index->gridId_ != grid.id()) continue;
+            used = uses;
+            if (index->version_ != grid.version()) {
+                if (index.use_count() > 1) index = std::make_shared<ComponentIndex>(*index);
+                index->update(grid, &ThreadPool::shared());
+            }
+            return index;
+        }
+
+        auto slot = cached.end();
+        if (cached.size() < kCachedGrids) slot = cached.emplace(cached.end());
+        else slot = std::min_element(cached.begin(), cached.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+        *slot = { uses, std::make_shared<ComponentIndex>(grid, &ThreadPool::shared()) };
+        return slot->second;
+    }
+
+private:
+    static constexpr int kRowsPerTask = 16;
+    static constexpr std::size_t kCachedGrids = 4;
+
+    void rebuild(const Grid& grid, ThreadPool* pool) {
+        int width = grid.width(), height = grid.height();
+        std::size_t cells = grid.cellCount();
+        std::vector<std::atomic<int>> parent(cells);
+
+        auto rows = [&](std::size_t task, auto&& body) {
+            int end = std::min(height, static_cast<int>(task + 1) * kRowsPerTask);
+            for (int y = static_cast<int>(task) * kRowsPerTask; y < end; ++y) body(y);
+        };
+        auto forEachTask = [&](auto&& fn) {
+            std::size_t tasks = (height + kRowsPerTask - 1) / kRowsPerTask;
+            if (pool) pool->parallelFor(tasks, [&](std::size_t task, unsigned) { fn(task); });
+            else for (std::size_t task = 0; task < tasks; ++task) fn(task);
+        };
+
+        forEachTask([&](std::size_t task) {
+            rows(task, [&](int y) {
+                for (int x = 0; x < width; ++x) parent[grid.index(x, y)].store(grid.index(x, y), std::memory_order_relaxed);
+                });
+            });
+        forEachTask([&](std::size_t task) {
+            rows(task, [&](int y) {
+                for (int x = 0; x < width; ++x) {
+                    if (grid.isWall(x, y)) continue;
+                    int cell = grid.index(x, y);
+                    if (x > 0 && !grid.isWall(x - 1, y)) unite(parent, cell, cell - 1);
+                    if (y > 0 && !grid.isWall(x, y - 1)) unite(parent, cell, cell - width);
+                }
+                });
+            });
+
+        // Roots are the smallest cell of their component, so one ordered pass
+        // numbers the components densely.
+        label_.assign(cells, -1);
+        int count = 0;
+        for (std::size_t cell = 0; cell < cells; ++cell) {
+            if (!grid.isWall(static_cast<int>(cell)) && parent[cell].load(std::memory_order_relaxed) == static_cast<int>(cell)) {
+                label_[cell] = count++;
+            }
+        }
+        forEachTask([&](std::size_t task) {
+            rows(task, [&](int y) {
+                for (int x = 0; x < width; ++x) {
+                    int cell = grid.index(x, y);
+                    if (grid.isWall(x, y)) continue;
+                    // Roots were labelled above and are only read here.
+                    int top = find(parent, cell);
+                    if (top != cell) label_[cell] = label_[top];
+                }
+                });
+            });
+
+        ids_.resize(count);
+        for (int id = 0; id < count; ++id) ids_[id] = { id, 0 };
+        width_ = width;
+        height_ = height;
+        mark_.assign(cells, 0);
+        stamp_ = 0;
+        gridId_ = grid.id();
+        version_ = grid.version();
+    }
+
+    // Lock-free find with path halving. Links only ever point to smaller
+    // cells, so a concurrent shortcut can never create a cycle.
+    static int find(std::vector<std::atomic<int>>& parent, int x) {
+        while (true) {
+            int up = parent[x].load();
+            if (up == x) return x;
+            int grand = parent[up].load();
+            if (grand != up) parent[x].compare_exchange_weak(up, grand);
+            x = grand;
+        }
+    }
+
+    static void unite(std::vector<std::atomic<int>>& parent, int a, int b) {
+        while (true) {
+            a = find(parent, a);
+            b = find(parent, b);
+            if (a == b) return;
+            if (a < b) std::swap(a, b);
+            // Fails if another thread linked a meanwhile; retry from the new roots.
+            int expected = a;
+            if (parent[a].compare_exchange_strong(expected, b)) return;
+        }
+    }
+
+    struct Id {
+        int parent;
+        std::uint8_t rank;
+    };
+
+    int root(int id) const {
+        while (ids_[id].parent != id) id = ids_[id].parent;
+        return id;
+    }
+
+    int compress(int id) {
+        int top = root(id);
+        while (ids_[id].parent != top) id = std::exchange(ids_[id].parent, top);
+        return top;
+    }
+
+    int freshId() {
+        ids_.push_back({ static_cast<int>(ids_.size()), 0 });
+        return static_cast<int>(ids_.size()) - 1;
+    }
+
+    void merge(int a, int b) {
+        a = compress(a);
+        b = compress(b);
+        if (a == b) return;
+        if (ids_[a].rank < ids_[b].rank) std::swap(a, b);
+        ids_[b].parent = a;
+        if (ids_[a].rank == ids_[b].rank) ++ids_[a].rank;
+    }
+
+    template <class Fn>
+    void forEachNeighbour(int cell, Fn&& fn) const {
+        int x = cell % width_, y = cell / width_;
+        if (x > 0) fn(cell - 1);
+        if (y > 0) fn(cell - width_);
+        if (y + 1 < height_) fn(cell + width_);
+        if (x + 1 < width_) fn(cell + 1);
+    }
+
+    void open(int cell) {
+        int id = freshId();
+        label_[cell] = id;
+        forEachNeighbour(cell, [&](int neighbour) {
+            if (label_[neighbour] >= 0) merge(id, label_[neighbour]);
+            });
+    }
+
+    // One flood per open neighbour of the closed cell; they all start in the
+    // same component. Floods that touch join a group. A group whose floods
+    // have all run dry while another group remains has been cut off, and its
+    // cells take a fresh id.
+    struct Flood {
+        int group;
+        bool retired;
+        std::size_t head;
+        std::vector<int> queue;
+    };
+
+    void close(int cell) {
+        label_[cell] = -1;
+
+        std::vector<Flood> floods;
+        forEachNeighbour(cell, [&](int neighbour) {
+            if (label_[neighbour] >= 0) floods.push_back({ static_cast<int>(floods.size()), false, 0, { neighbour } });
+            });
+        if (floods.size() < 2) return;
+
+        // Stamps tell which flood reached a cell during this call. They are
+        // cleared once the counter nears its end.
+        if (stamp_ > 0xffffffffu - 8) {
+            std::fill(mark_.begin(), mark_.end(), 0);
+            stamp_ = 0;
+        }
+        const std::uint32_t base = stamp_ + 1;
+        stamp_ += static_cast<std::uint32_t>(floods.size());
+        for (std::size_t i = 0; i < floods.size(); ++i) mark_[floods[i].queue[0]] = base + static_cast<std::uint32_t>(i);
+
+        auto groupOf = [&](int flood) {
+            while (floods[flood].group != flood) flood = floods[flood].group;
+            return flood;
+        };
+
+        while (true) {
+            // Sort out the groups: done once one is left, and a group with no
+            // live flood is a finished piece.
+            int groups = 0, dry = -1;
+            for (std::size_t i = 0; i < floods.size(); ++i) {
+                if (floods[i].retired || groupOf(static_cast<int>(i)) != static_cast<int>(i)) continue;
+                ++groups;
+                bool live = false;
+                for (std::size_t j = 0; j < floods.size(); ++j) {
+                    if (groupOf(static_cast<int>(j)) == static_cast<int>(i) && floods[j].head < floods[j].queue.size()) live = true;
+                }
+                if (!live) dry = static_cast<int>(i);
+            }
+            if (groups < 2) return;
+
+            if (dry >= 0) {
+                int id = freshId();
+                for (std::size_t j = 0; j < floods.size(); ++j) {
+                    if (groupOf(static_cast<int>(j)) != dry) continue;
+                    for (int reached : floods[j].queue) label_[reached] = id;
+                    floods[j].retired = true;
+                }
+                continue;
+            }
+
+            for (std::size_t i = 0; i < floods.size(); ++i) {
+                Flood& flood = floods[i];
+                if (flood.head == flood.queue.size()) continue;
+                int current = flood.queue[flood.head++];
+                forEachNeighbour(current, [&](int next) {
+                    if (label_[next] < 0) return;
+                    std::uint32_t mark = mark_[next];
+                    if (mark >= base && mark < base + floods.size()) {
+                        int a = groupOf(static_cast<int>(i)), b = groupOf(static_cast<int>(mark - base));
+                        if (a != b) floods[std::max(a, b)].group = std::min(a, b);
+                        return;
+                    }
+                    mark_[next] = base + static_cast<std::uint32_t>(i);
+                    flood.queue.push_back(next);
+                    });
+            }
+        }
+    }
+
+    int width_ = 0, height_ = 0;
+    std::uint64_t gridId_ = 0, version_ = 0;
+    std::vector<int> label_;          // component id per open cell, -1 for walls
+    std::vector<Id> ids_;             // union-find over component ids
+    std::vector<std::uint32_t> mark_; // flood stamps, see close()
+    std::uint32_t stamp_ = 0;
+};
+
+} // namespace Pathfinding
@@ -0,0 +1,288 @@
+#pragma once
+
+#include "Grid.hpp"
+#include "SearchArena.hpp"
+#include "SearchKernel.hpp"
+#include "SearchObserver.hpp"
+#include "SearchResult.hpp"
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace Pathfinding {
+
+// Distances to one goal from every cell, plus the direction each cell should
+// step in, so any number of agents heading to that goal can follow the field
+// in O(path length) without searching. Moves are 4-connected and pay the cost
+// of the cell entered, as in Dijkstra, so every path it gives is optimal.
+//
+// The integration field is a backward Dijkstra from the goal, split into
+// square tiles run in parallel. Each round, every active tile pulls in its
+// neighbours' border distances and settles its own cells with a local
+// Dijkstra. A tile whose border improved wakes the tiles beside it for the
+// next round. Distances only ever decrease, so tiles may read a neighbour's
+// border mid-update; the wake-up guarantees the final value is seen. Rounds
+// end when no tile is awake, and the distances are then exact. Without a pool
+// the whole grid is one tile, so the field is a single plain Dijkstra.
+class FlowField {
+public:
+    static constexpr std::uint32_t kUnreachable = 0xffffffffu;
+    static constexpr std::uint8_t kNoDirection = 0xff;
+    static constexpr int kTileSize = 64;
+
+    FlowField(const Grid& grid, int goal, ThreadPool* pool = nullptr)
+        : width_(grid.width()), height_(grid.height()), goal_(goal),
+        tileSize_(pool ? kTileSize : std::max(1, std::max(grid.width(), grid.height()))), gridId_(grid.id()), version_(grid.version()) {
+        integrate(grid, pool);
+    }
+
+    int goal() const { return goal_; }
+
+    // Cost of the cheapest path from cell to the goal; kUnreachable when there
+    // is none. Walls are unreachable.
+    std::uint32_t distance(int cell) const { return distances_[cell]; }
+
+    // Neighbour to step to from an open cell, or -1 at the goal and where the
+    // goal cannot be reached.
+    int next(int cell) const {
+        std::uint8_t d = directions_[cell];
+        if (d == kNoDirection) return -1;
+        return cell + FourConnected::kDy[d] * width_ + FourConnected::kDx[d];
+    }
+
+    // Follows the field from start to the goal. A walled start steps onto its
+    // best open neighbour first, as the searches would.
+    template <class Observer>
+    SearchResult path(const Grid& grid, int start, Observer& observer) const {
+        SearchResult result;
+        int first = start;
+        if (start != goal_ && grid.isWall(start)) {
+            std::uint64_t best = kUnreachable;
+            Neighbours<FourConnected>::forEach(grid, start, [&](int neighbour, int) {
+                std::uint64_t through = std::uint64_t(distances_[neighbour]) + grid.cost(neighbour);
+                if (distances_[neighbour] != kUnreachable && through < best) {
+                    best = through;
+                    first = neighbour;
+                }
+                });
+            if (first == start) return result;
+            result.path.push_back(start);
+            observer.onPath(start);
+        }
+        else if (start != goal_ && next(start) < 0) {
+            return result;
+        }
+
+        result.found = true;
+        for (int cell = first; cell >= 0; cell = next(cell)) {
+            result.path.push_back(cell);
+            observer.onPath(cell);
+        }
+        return result;
+    }
+
+    SearchResult path(const Grid& grid, int start) const {
+        NullObserver observer;
+        return path(grid, start, observer);
+    }
+
+    // Field for the grid's current contents and this goal, shared by every
+    // thread. Fields for the few (grid, goal) pairs used most recently are
+    // kept, so queries alternating between goals do not rebuild each time;
+    // a field is rebuilt when its grid changes.
+    static std::shared_ptr<const FlowField> shared(const Grid& grid, int goal) {
+        static std::mutex mutex;
+        static std::vector<std::pair<std::uint64_t, std::shared_ptr<const FlowField>>> cached; // last use, field
+        static std::uint64_t uses = 0;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        ++uses;
+        for (auto& [used, field] : cached) {
+            if (field->gridId_ != grid.id() || field->goal_ != goal) continue;
+            used = uses;
+            if (field->version_ != grid.version()) field = std::make_shared<const FlowField>(grid, goal, &ThreadPool::shared());
+            return field;
+        }
+
+        auto slot = cached.end();
+        if (cached.size() < kCachedFields) slot = cached.emplace(cached.end());
+        else slot = std::min_element(cached.begin(), cached.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+        *slot = { uses, std::make_shared<const FlowField>(grid, goal, &ThreadPool::shared()) };
+        return slot->second;
+    }
+
+private:
+    using Entry = std::pair<std::uint32_t, int>; // distance, cell
+
+    static constexpr std::size_t kCachedFields = 8;
+
+    // Per-worker memory for settleTile.
+    struct Scratch {
+        std::vector<Entry> seeds;
+        BucketQueue queue;
+    };
+
+    int tilesX() const { return (width_ + tileSize_ - 1) / tileSize_; }
+    int tilesY() const { return (height_ + tileSize_ - 1) / tileSize_; }
+
+    template <class Fn>
+    static void forEach(ThreadPool* pool, std::size_t count, Fn&& fn) {
+        if (pool) pool->parallelFor(count, fn);
+        else for (std::size_t i = 0; i < count; ++i) fn(i, 0);
+    }
+
+    void integrate(const Grid& grid, ThreadPool* pool) {
+        std::size_t cells = grid.cellCount();
+        std::vector<std::atomic<std::uint32_t>> field(cells);
+        for (std::size_t cell = 0; cell < cells; ++cell) field[cell].store(kUnreachable, std::memory_order_relaxed);
+
+        std::size_t tiles = static_cast<std::size_t>(tilesX()) * tilesY();
+        std::vector<std::atomic<bool>> awake(tiles);
+        for (std::atomic<bool>& flag : awake) flag.store(false, std::memory_order_relaxed);
+        std::vector<Scratch> scratch(pool ? pool->size() : 1);
+        // Each cell's direction is written only by the tile that owns it.
+        directions_.assign(cells, kNoDirection);
+
+        std::vector<int> active;
+        if (goal_ >= 0 && goal_ < static_cast<int>(cells) && !grid.isWall(goal_)) {
+            field[goal_].store(0, std::memory_order_relaxed);
+            int gx = goal_ % width_, gy = goal_ / width_;
+            int tx = gx / tileSize_, ty = gy / tileSize_;
+            active.push_back(ty * tilesX() + tx);
+            // The goal is not lowered by settleTile, so it never marks the
+            // tile edge it sits on; wake the tiles across that edge here.
+            if (gx % tileSize_ == 0 && tx > 0) awake[ty * tilesX() + tx - 1].store(true, std::memory_order_relaxed);
+            if (gx % tileSize_ == tileSize_ - 1 && tx + 1 < tilesX()) awake[ty * tilesX() + tx + 1].store(true, std::memory_order_relaxed);
+            if (gy % tileSize_ == 0 && ty > 0) awake[(ty - 1) * tilesX() + tx].store(true, std::memory_order_relaxed);
+            if (gy % tileSize_ == tileSize_ - 1 && ty + 1 < tilesY()) awake[(ty + 1) * tilesX() + tx].store(true, std::memory_order_relaxed);
+        }
+        while (!active.empty()) {
+            forEach(pool, active.size(), [&](std::size_t i, unsigned worker) {
+                settleTile(grid, active[i], field, awake, scratch[worker]);
+                });
+            active.clear();
+            for (std::size_t tile = 0; tile < tiles; ++tile) {
+                if (awake[tile].exchange(false, std::memory_order_relaxed)) active.push_back(static_cast<int>(tile));
+            }
+        }
+
+        distances_.resize(cells);
+        for (std::size_t cell = 0; cell < cells; ++cell) distances_[cell] = field[cell].load(std::memory_order_relaxed);
+    }
+
+    // Settles one tile against its neighbours' current border distances and
+    // wakes each neighbouring tile whose shared border improved.
+    void settleTile(const Grid& grid, int tile, std::vector<std::atomic<std::uint32_t>>& field,
+        std::vector<std::atomic<bool>>& awake, Scratch& scratch) {
+        int tx = tile % tilesX(), ty = tile / tilesX();
+        int x0 = tx * tileSize_, y0 = ty * tileSize_;
+        int x1 = std::min(width_, x0 + tileSize_), y1 = std::min(height_, y0 + tileSize_);
+        auto load = [&](int cell) { return field[cell].load(std::memory_order_relaxed); };
+
+        bool left = false, right = false, up = false, down = false;
+        // Directions are numbered as in FourConnected, where 3 - d is the
+        // opposite of d.
+        auto lower = [&](int cell, int x, int y, std::uint32_t d, int direction) {
+            field[cell].store(d, std::memory_order_relaxed);
+            directions_[cell] = static_cast<std::uint8_t>(direction);
+            left |= x == x0;
+            right |= x == x1 - 1;
+            up |= y == y0;
+            down |= y == y1 - 1;
+        };
+
+        // The interior is already settled against itself, so only the border
+        // cells the neighbours improve (and the goal) seed the local search.
+        std::vector<Entry>& seeds = scratch.seeds;
+        seeds.clear();
+        if (goal_ % width_ >= x0 && goal_ % width_ < x1 && goal_ / width_ >= y0 && goal_ / width_ < y1) seeds.push_back({ 0, goal_ });
+        auto pull = [&](int x, int y) {
+            if (grid.isWall(x, y)) return;
+            int cell = grid.index(x, y);
+            std::uint32_t best = load(cell);
+            int direction = -1;
+            auto from = [&](int nx, int ny, int d) {
+                if (grid.isWall(nx, ny)) return;
+                int outside = grid.index(nx, ny);
+                std::uint32_t distance = load(outside);
+                if (distance != kUnreachable && distance + grid.cost(outside) < best) {
+                    best = distance + grid.cost(outside);
+                    direction = d;
+                }
+            };
+            if (x == x0 && x > 0) from(x - 1, y, 0);
+            if (y == y0 && y > 0) from(x, y - 1, 1);
+            if (y == y1 - 1 && y1 < height_) from(x, y + 1, 2);
+            if (x == x1 - 1 && x1 < width_) from(x + 1, y, 3);
+            if (direction >= 0) {
+                lower(cell, x, y, best, direction);
+                seeds.push_back({ best, cell });
+            }
+        };
+        for (int x = x0; x < x1; ++x) {
+            pull(x, y0);
+            if (y1 - 1 > y0) pull(x, y1 - 1);
+        }
+        for (int y = y0 + 1; y < y1 - 1; ++y) {
+            pull(x0, y);
+            if (x1 - 1 > x0) pull(x1 - 1, y);
+        }
+
+        // Seeds go in sorted and only once they come within one step of the
+        // smallest key, so every key in the bucket queue stays inside its ring.
+        std::sort(seeds.begin(), seeds.end());
+        BucketQueue& queue = scratch.queue;
+        std::size_t next = 0;
+        int current = 0;
+        while (true) {
+            if (queue.empty()) {
+                if (next == seeds.size()) break;
+                current = static_cast<int>(seeds[next].first);
+                queue.reset(Grid::kMaxCost + 1, current);
+            }
+            for (; next < seeds.size() && static_cast<int>(seeds[next].first) <= current + Grid::kMaxCost; ++next) {
+                queue.push(seeds[next].first, { seeds[next].second, static_cast<int>(seeds[next].first) });
+            }
+
+            BucketQueue::Entry entry = queue.pop(current);
+            if (static_cast<std::uint32_t>(current) > load(entry.index)) continue;
+
+            int x = entry.index % width_, y = entry.index / width_;
+            std::uint32_t through = current + grid.cost(entry.index);
+            auto relax = [&](int px, int py, int d) {
+                if (grid.isWall(px, py)) return;
+                int previous = grid.index(px, py);
+                if (through >= load(previous)) return;
+                lower(previous, px, py, through, 3 - d);
+                queue.push(static_cast<int>(through), { previous, static_cast<int>(through) });
+            };
+            if (x > x0) relax(x - 1, y, 0);
+            if (y > y0) relax(x, y - 1, 1);
+            if (y + 1 < y1) relax(x, y + 1, 2);
+            if (x + 1 < x1) relax(x + 1, y, 3);
+        }
+
+        auto wake = [&](bool changed, int nx, int ny) {
+            if (changed && nx >= 0 && nx < tilesX() && ny >= 0 && ny < tilesY()) awake[ny * tilesX() + nx].store(true, std::memory_order_relaxed);
+        };
+        wake(left, tx - 1, ty);
+        wake(right, tx + 1, ty);
+        wake(up, tx, ty - 1);
+        wake(down, tx, ty + 1);
+    }
+
+    int width_, height_, goal_;
+    int tileSize_;
+    std::uint64_t gridId_, version_;
+    std::vector<std::uint32_t> distances_;  // integration field
+    std::vector<std::uint8_t> directions_;  // index into FourConnected's directions
+};
+
+} // namespace Pathfinding
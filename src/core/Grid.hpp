@@ -0,0 +1,174 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Pathfinding {
+
+struct Point {
+    int x = -1, y = -1;
+
+    Point() = default;
+    Point(int x, int y) : x(x), y(y) {}
+
+    bool operator==(const Point& other) const { return x == other.x && y == other.y; }
+    bool operator!=(const Point& other) const { return !(*this == other); }
+};
+
+// Runtime-sized walkability grid. Walls are stored as a packed bitmap with every
+// row padded to whole 64-bit words, so a row can be processed as a bitset. Cells
+// are addressed by a linear int32 index (y * width + x), which caps a grid at
+// 2^31 cells.
+//
+// Open cells also have an integer cost of entering them, 1 to kMaxCost. A
+// byte per cell is allocated only once some cell costs more than 1, so
+// uniform maps keep the bitmap alone. Dijkstra and A* honour costs; the other
+// searches treat every open cell as cost 1.
+//
+// id() and version() together identify the grid's contents: every grid (copies
+// included) gets a fresh id and every edit bumps the version, so per-map caches
+// can key on the pair without comparing cells. Recent wall edits are also kept
+// in a bounded journal, so incremental consumers can catch up with
+// changesSince() instead of rescanning the map.
+class Grid {
+public:
+    Grid(int width, int height) { resize(width, height); }
+
+    int width() const { return width_; }
+    int height() const { return height_; }
+    int cellCount() const { return width_ * height_; }
+    int wordsPerRow() const { return wordsPerRow_; }
+
+    std::uint64_t id() const { return id_.value; }
+    std::uint64_t version() const { return version_; }
+
+    int index(int x, int y) const { return y * width_ + x; }
+    Point point(int index) const { return { index % width_, index / width_ }; }
+
+    bool inBounds(int x, int y) const { return x >= 0 && x < width_ && y >= 0 && y < height_; }
+
+    bool isWall(int x, int y) const {
+        return (walls_[static_cast<std::size_t>(y) * wordsPerRow_ + (x >> 6)] >> (x & 63)) & 1;
+    }
+    bool isWall(int index) const { return isWall(index % width_, index / width_); }
+
+    static constexpr int kMaxCost = 9;
+
+    int cost(int index) const { return costs_.empty() ? 1 : costs_[index]; }
+    int cost(int x, int y) const { return cost(index(x, y)); }
+    // Whether costs are stored; false guarantees every cell costs 1.
+    bool weighted() const { return !costs_.empty(); }
+
+    void setCost(int x, int y, int cost) {
+        cost = std::max(1, std::min(cost, kMaxCost));
+        if (costs_.empty()) {
+            if (cost == 1) return;
+            costs_.assign(cellCount(), 1);
+        }
+        costs_[index(x, y)] = static_cast<std::uint8_t>(cost);
+        ++version_;
+    }
+
+    void setWall(int x, int y, bool wall) {
+        std::uint64_t& word = walls_[static_cast<std::size_t>(y) * wordsPerRow_ + (x >> 6)];
+        std::uint64_t bit = std::uint64_t(1) << (x & 63);
+        bool changed = ((word & bit) != 0) != wall;
+        word = wall ? (word | bit) : (word & ~bit);
+        ++version_;
+        if (changed) record(index(x, y));
+    }
+
+    // Replaces the walls of row y with wordsPerRow() packed words, as row()
+    // returns them; bits past width() must be zero. Used by map loaders; the
+    // edit is not journaled, so changesSince() reports a full rescan.
+    void setRow(int y, const std::uint64_t* words) {
+        std::copy(words, words + wordsPerRow_, walls_.begin() + static_cast<std::size_t>(y) * wordsPerRow_);
+        ++version_;
+        resetJournal();
+    }
+
+    // Appends the cells whose wall state changed after `version` (oldest
+    // first, possibly repeated) and returns true. Returns false when the
+    // journal no longer reaches back that far or the grid was resized or
+    // cleared since; callers must then treat every cell as changed.
+    bool changesSince(std::uint64_t version, std::vector<int>& cells) const {
+        if (version < journalBase_ || version > version_) return false;
+        auto first = std::upper_bound(journal_.begin(), journal_.end(), version,
+            [](std::uint64_t v, const Change& change) { return v < change.version; });
+        for (auto it = first; it != journal_.end(); ++it) cells.push_back(it->index);
+        return true;
+    }
+
+    // Wall bits of row y; bits past width() are always zero.
+    const std::uint64_t* row(int y) const { return walls_.data() + static_cast<std::size_t>(y) * wordsPerRow_; }
+
+    void resize(int width, int height) {
+        width_ = width;
+        height_ = height;
+        wordsPerRow_ = (width + 63) / 64;
+        walls_.assign(static_cast<std::size_t>(wordsPerRow_) * height, 0);
+        costs_.clear();
+        ++version_;
+        resetJournal();
+    }
+
+    void clear() {
+        walls_.assign(walls_.size(), 0);
+        costs_.clear();
+        ++version_;
+        resetJournal();
+    }
+
+private:
+    struct Change {
+        std::uint64_t version;
+        int index;
+    };
+
+    static constexpr std::size_t kJournalLimit = 1 << 16;
+
+    void record(int cell) {
+        if (journal_.size() == kJournalLimit) {
+            // Drop the older half; the journal now starts after its last version.
+            journalBase_ = journal_[kJournalLimit / 2 - 1].version;
+            journal_.erase(journal_.begin(), journal_.begin() + kJournalLimit / 2);
+        }
+        journal_.push_back({ version_, cell });
+    }
+
+    void resetJournal() {
+        journal_.clear();
+        journalBase_ = version_;
+    }
+
+    // Process-wide unique id; copying or assigning a grid draws a new one.
+    struct Identity {
+        std::uint64_t value = next();
+
+        Identity() = default;
+        Identity(const Identity&) : value(next()) {}
+        Identity& operator=(const Identity&) {
+            value = next();
+            return *this;
+        }
+
+        static std::uint64_t next() {
+            static std::atomic<std::uint64_t> counter{ 0 };
+            return ++counter;
+        }
+    };
+
+    Identity id_;
+    std::uint64_t version_ = 0;
+    int width_ = 0, height_ = 0;
+    int wordsPerRow_ = 0;
+    std::vector<std::uint64_t> walls_;
+    std::vector<std::uint8_t> costs_; // empty while every cell costs 1
+    std::vector<Change> journal_;     // wall edits in version order
+    std::uint64_t journalBase_ = 0;   // the journal covers every edit after this version
+};
+
+} // namespace Pathfinding
@@ -0,0 +1,441 @@
+#pragma once
+
+#include "Grid.hpp"
+#include "SearchArena.hpp"
+#include "SearchObserver.hpp"
+#include "SearchResult.hpp"
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Pathfinding {
+
+// HPA*: the map is cut into square clusters. Wherever two neighbouring
+// clusters share a run of open cells along their border, the run gets one
+// entrance in its middle, or one at each end if it is long. The entrance cells
+// become nodes of an abstract graph. Nodes in the same cluster are joined by
+// their precomputed in-cluster distance, and nodes that face each other
+// across a border are joined by a single step.
+//
+// A query links its endpoints to the nodes of their clusters, runs A* on the
+// abstract graph and then refines every hop with a BFS confined to one cluster.
+// Paths stay inside the corridors the entrances allow, so they can be slightly
+// longer than optimal. In exchange, the work depends on the number of clusters
+// crossed rather than the area between the endpoints.
+//
+// Each cluster's nodes depend only on the walls along its own borders, so
+// clusters are built independently, in parallel when given a pool, and an
+// edit rebuilds the edited cluster, plus its neighbour when the cell lies on
+// their shared edge.
+class HierarchicalMap {
+public:
+    static constexpr int kDefaultClusterSize = 32;
+
+    explicit HierarchicalMap(const Grid& grid, int clusterSize = kDefaultClusterSize, ThreadPool* pool = nullptr)
+        // Distances inside a cluster must fit the 16-bit table entries.
+        : clusterSize_(std::max(4, std::min(clusterSize, 128))) {
+        rebuild(grid, pool);
+    }
+
+    int clusterSize() const { return clusterSize_; }
+    int nodeCount() const { return offset_.empty() ? 0 : offset_.back(); }
+
+    // Catches up with wall edits made since this map was built or last updated.
+    // Only the affected clusters are rebuilt unless the grid's journal no
+    // longer covers the gap, the grid was resized, or it is another grid.
+    void update(const Grid& grid, ThreadPool* pool = nullptr) {
+        if (grid.id() == gridId_ && grid.version() == version_) return;
+
+        std::vector<int> changed;
+        if (grid.id() != gridId_ || !grid.changesSince(version_, changed)) {
+            rebuild(grid, pool);
+            return;
+        }
+
+        std::vector<int> dirty;
+        for (int cell : changed) {
+            int x = cell % width_, y = cell / width_;
+            int cx = x / clusterSize_, cy = y / clusterSize_;
+            dirty.push_back(clusterAt(cx, cy));
+            // A border cell also decides the entrances of the cluster across it.
+            if (x % clusterSize_ == 0 && cx > 0) dirty.push_back(clusterAt(cx - 1, cy));
+            if ((x + 1) % clusterSize_ == 0 && cx + 1 < clustersX_) dirty.push_back(clusterAt(cx + 1, cy));
+            if (y % clusterSize_ == 0 && cy > 0) dirty.push_back(clusterAt(cx, cy - 1));
+            if ((y + 1) % clusterSize_ == 0 && cy + 1 < clustersY_) dirty.push_back(clusterAt(cx, cy + 1));
+        }
+        std::sort(dirty.begin(), dirty.end());
+        dirty.erase(std::unique(dirty.begin(), dirty.end()), dirty.end());
+
+        buildClusters(grid, dirty.size(), [&](std::size_t i) { return dirty[i]; }, pool);
+        updateOffsets();
+        version_ = grid.version();
+    }
+
+    // Abstract nodes go through the arena: the node id stands in for a cell.
+    // Observers see the entrances the abstract search touches and then the
+    // refined path.
+    template <class Observer>
+    SearchResult search(const Grid& grid, int start, int end, Observer& observer, SearchArena& arena) const {
+        if (grid.isWall(end)) return {};
+        if (start == end) {
+            SearchResult result;
+            result.found = true;
+            result.path.push_back(start);
+            return result;
+        }
+
+        const int startId = nodeCount(), endId = nodeCount() + 1;
+        Scratch scratch;
+        std::vector<Link> startLinks = linkEndpoint(grid, start, scratch);
+        std::vector<Link> endLinks = linkEndpoint(grid, end, scratch);
+        int endCluster = clusterOf(end);
+        int direct = clusterOf(start) == endCluster ? distanceInCluster(grid, start, end, scratch) : -1;
+
+        arena.begin(nodeCount() + 2);
+        arena.open.push({ manhattan(start, end), 0, startId });
+        arena.reach(startId, 0, -1);
+
+        auto relax = [&](int from, int g, int to, int step) {
+            int cost = g + step;
+            if (cost >= arena.cost(to)) return;
+            arena.reach(to, cost, from);
+            int cell = to == endId ? end : cellOf(to);
+            arena.open.push({ cost + manhattan(cell, end), -cost, to });
+            observer.onVisit(cell);
+        };
+
+        bool found = false;
+        while (!arena.open.empty()) {
+            OpenList::Entry top = arena.open.top();
+            arena.open.pop();
+            int id = top.index, g = -top.tie;
+            if (g > arena.cost(id)) continue;
+            if (id == endId) {
+                found = true;
+                break;
+            }
+
+            if (id == startId) {
+                for (const Link& link : startLinks) relax(id, g, link.node, link.distance);
+                if (direct >= 0) relax(id, g, endId, direct);
+                continue;
+            }
+
+            int cluster = clusterOfNode(id);
+            int local = id - offset_[cluster];
+            const Cluster& c = clusters_[cluster];
+            int cell = c.cells[local];
+            observer.onExpand(cell);
+
+            int n = static_cast<int>(c.cells.size());
+            for (int j = 0; j < n; ++j) {
+                std::uint16_t d = c.distance[local * n + j];
+                if (j != local && d != kFar) relax(id, g, offset_[cluster] + j, d);
+            }
+            forEachCrossing(grid, cell, [&](int neighbourNode) { relax(id, g, neighbourNode, 1); });
+            if (cluster == endCluster) {
+                for (const Link& link : endLinks) {
+                    if (link.node == id) relax(id, g, endId, link.distance);
+                }
+            }
+        }
+        if (!found) return {};
+
+        std::vector<int> waypoints;
+        for (int id = endId; id != -1; id = arena.parent(id)) {
+            waypoints.push_back(id == endId ? end : id == startId ? start : cellOf(id));
+        }
+        std::reverse(waypoints.begin(), waypoints.end());
+
+        SearchResult result;
+        result.found = true;
+        result.path.push_back(start);
+        for (std::size_t i = 1; i < waypoints.size(); ++i) {
+            int from = waypoints[i - 1], to = waypoints[i];
+            if (clusterOf(from) != clusterOf(to)) {
+                result.path.push_back(to);
+            }
+            else {
+                refine(grid, from, to, result.path, scratch);
+            }
+        }
+        for (auto it = result.path.rbegin(); it != result.path.rend() - 1; ++it) observer.onPath(*it);
+        return result;
+    }
+
+    // Map for the grid, shared by every thread. Edits are applied with update()
+    // when possible; a map still held by another caller is copied first, so
+    // pointers handed out earlier never change underneath their holders.
+    static std::shared_ptr<const HierarchicalMap> shared(const Grid& grid) {
+        static std::mutex mutex;
+        static std::shared_ptr<HierarchicalMap> cached;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!cached) {
+            cached = std::make_shared<HierarchicalMap>(grid, kDefaultClusterSize, &ThreadPool::shared());
+        }
+        else if (cached->gridId_ != grid.id() || cached->version_ != grid.version()) {
+            if (cached.use_count() > 1) cached = std::make_shared<HierarchicalMap>(*cached);
+            cached->update(grid, &ThreadPool::shared());
+        }
+        return cached;
+    }
+
+private:
+    static constexpr std::uint16_t kFar = 0xffff;
+    static constexpr int kLongRun = 6; // runs at least this long get an entrance at each end
+
+    struct Cluster {
+        std::vector<int> cells;               // entrance cells, sorted
+        std::vector<std::uint16_t> distance;  // cells.size()^2 in-cluster distances, kFar if none
+    };
+
+    struct Rect {
+        int x0, y0, x1, y1; // [x0, x1) x [y0, y1)
+    };
+
+    struct Link {
+        int node;
+        int distance;
+    };
+
+    // BFS buffers sized for one framed cluster.
+    struct Scratch {
+        std::vector<std::uint8_t> open;
+        std::vector<int> distance, parent, queue, order;
+    };
+
+    int clusterAt(int cx, int cy) const { return cy * clustersX_ + cx; }
+    int clusterOf(int cell) const { return clusterAt(cell % width_ / clusterSize_, cell / width_ / clusterSize_); }
+
+    int clusterOfNode(int id) const {
+        return static_cast<int>(std::upper_bound(offset_.begin(), offset_.end(), id) - offset_.begin()) - 1;
+    }
+
+    int cellOf(int id) const {
+        int cluster = clusterOfNode(id);
+        return clusters_[cluster].cells[id - offset_[cluster]];
+    }
+
+    int nodeAt(int cluster, int cell) const {
+        const std::vector<int>& cells = clusters_[cluster].cells;
+        auto it = std::lower_bound(cells.begin(), cells.end(), cell);
+        return it != cells.end() && *it == cell ? offset_[cluster] + static_cast<int>(it - cells.begin()) : -1;
+    }
+
+    Rect rect(int cluster) const {
+        int cx = cluster % clustersX_, cy = cluster / clustersX_;
+        return { cx * clusterSize_, cy * clusterSize_,
+            std::min(width_, (cx + 1) * clusterSize_), std::min(height_, (cy + 1) * clusterSize_) };
+    }
+
+    int manhattan(int a, int b) const {
+        return std::abs(a % width_ - b % width_) + std::abs(a / width_ - b / width_);
+    }
+
+    void rebuild(const Grid& grid, ThreadPool* pool) {
+        width_ = grid.width();
+        height_ = grid.height();
+        clustersX_ = (width_ + clusterSize_ - 1) / clusterSize_;
+        clustersY_ = (height_ + clusterSize_ - 1) / clusterSize_;
+        clusters_.assign(static_cast<std::size_t>(clustersX_) * clustersY_, Cluster());
+
+        buildClusters(grid, clusters_.size(), [](std::size_t i) { return static_cast<int>(i); }, pool);
+        updateOffsets();
+        gridId_ = grid.id();
+        version_ = grid.version();
+    }
+
+    // Builds count clusters, cluster(i) naming the i-th, with one Scratch per
+    // worker. Each build writes only its own cluster.
+    template <class Pick>
+    void buildClusters(const Grid& grid, std::size_t count, Pick cluster, ThreadPool* pool) {
+        std::vector<Scratch> scratch(pool ? pool->size() : 1);
+        auto build = [&](std::size_t i, unsigned worker) { buildCluster(grid, cluster(i), scratch[worker]); };
+        if (pool) pool->parallelFor(count, build);
+        else for (std::size_t i = 0; i < count; ++i) build(i, 0);
+    }
+
+    void updateOffsets() {
+        offset_.assign(clusters_.size() + 1, 0);
+        for (std::size_t i = 0; i < clusters_.size(); ++i) {
+            offset_[i + 1] = offset_[i] + static_cast<int>(clusters_[i].cells.size());
+        }
+    }
+
+    // Picks entrances along one border. mine(i) and theirs(i) are the cells on
+    // either side at position i; entrances land on this cluster's side.
+    template <class Mine, class Theirs>
+    static void scanBorder(const Grid& grid, int length, Mine mine, Theirs theirs, std::vector<int>& cells) {
+        auto open = [&](int cell) { return !grid.isWall(cell % grid.width(), cell / grid.width()); };
+        for (int i = 0; i < length;) {
+            if (!open(mine(i)) || !open(theirs(i))) {
+                ++i;
+                continue;
+            }
+            int begin = i;
+            while (i < length && open(mine(i)) && open(theirs(i))) ++i;
+            if (i - begin >= kLongRun) {
+                cells.push_back(mine(begin));
+                cells.push_back(mine(i - 1));
+            }
+            else {
+                cells.push_back(mine(begin + (i - begin - 1) / 2));
+            }
+        }
+    }
+
+    void buildCluster(const Grid& grid, int cluster, Scratch& scratch) {
+        Rect r = rect(cluster);
+        int w = width_;
+        int rw = r.x1 - r.x0, rh = r.y1 - r.y0;
+        Cluster& c = clusters_[cluster];
+        c.cells.clear();
+
+        if (r.x0 > 0) {
+            scanBorder(grid, rh, [&](int i) { return (r.y0 + i) * w + r.x0; }, [&](int i) { return (r.y0 + i) * w + r.x0 - 1; }, c.cells);
+        }
+        if (r.x1 < width_) {
+            scanBorder(grid, rh, [&](int i) { return (r.y0 + i) * w + r.x1 - 1; }, [&](int i) { return (r.y0 + i) * w + r.x1; }, c.cells);
+        }
+        if (r.y0 > 0) {
+            scanBorder(grid, rw, [&](int i) { return r.y0 * w + r.x0 + i; }, [&](int i) { return (r.y0 - 1) * w + r.x0 + i; }, c.cells);
+        }
+        if (r.y1 < height_) {
+            scanBorder(grid, rw, [&](int i) { return (r.y1 - 1) * w + r.x0 + i; }, [&](int i) { return r.y1 * w + r.x0 + i; }, c.cells);
+        }
+        std::sort(c.cells.begin(), c.cells.end());
+        c.cells.erase(std::unique(c.cells.begin(), c.cells.end()), c.cells.end());
+
+        int n = static_cast<int>(c.cells.size());
+        c.distance.assign(static_cast<std::size_t>(n) * n, kFar);
+        if (n == 0) return;
+
+        // Distances are symmetric: the BFS from node i only has to find the
+        // nodes after it, and stops once it has.
+        load(grid, r, scratch);
+        scratch.order.assign(scratch.open.size(), -1);
+        for (int j = 0; j < n; ++j) scratch.order[local(r, c.cells[j])] = j;
+        for (int i = 0; i + 1 < n; ++i) {
+            int remaining = n - 1 - i;
+            bfs(r, c.cells[i], scratch, false, [&](int at) { return scratch.order[at] > i && --remaining == 0; });
+            for (int j = i + 1; j < n; ++j) {
+                int d = scratch.distance[local(r, c.cells[j])];
+                if (d >= 0) c.distance[i * n + j] = c.distance[j * n + i] = static_cast<std::uint16_t>(d);
+            }
+        }
+        for (int i = 0; i < n; ++i) c.distance[i * n + i] = 0;
+    }
+
+    // Local cells are indexed inside a one-cell frame around the cluster, so
+    // the BFS needs no bounds checks: the frame reads as wall.
+    int local(const Rect& r, int cell) const {
+        return (cell / width_ - r.y0 + 1) * (r.x1 - r.x0 + 2) + (cell % width_ - r.x0 + 1);
+    }
+
+    int global(const Rect& r, int at) const {
+        int stride = r.x1 - r.x0 + 2;
+        return (r.y0 + at / stride - 1) * width_ + r.x0 + at % stride - 1;
+    }
+
+    void load(const Grid& grid, const Rect& r, Scratch& scratch) const {
+        int stride = r.x1 - r.x0 + 2;
+        scratch.open.assign(static_cast<std::size_t>(stride) * (r.y1 - r.y0 + 2), 0);
+        for (int y = r.y0; y < r.y1; ++y) {
+            for (int x = r.x0; x < r.x1; ++x) {
+                scratch.open[(y - r.y0 + 1) * stride + x - r.x0 + 1] = !grid.isWall(x, y);
+            }
+        }
+    }
+
+    // BFS from source over the cluster loaded into scratch. Distances (-1 when
+    // unreachable) and, if asked, parents are indexed by local cell. Stops
+    // early once stop(localCell) returns true for a newly reached cell.
+    template <class Stop>
+    void bfs(const Rect& r, int source, Scratch& scratch, bool parents, Stop stop) const {
+        int stride = r.x1 - r.x0 + 2;
+        scratch.distance.assign(scratch.open.size(), -1);
+        if (parents) scratch.parent.assign(scratch.open.size(), -1);
+        scratch.queue.clear();
+
+        int origin = local(r, source);
+        scratch.distance[origin] = 0;
+        scratch.queue.push_back(origin);
+        for (std::size_t head = 0; head < scratch.queue.size(); ++head) {
+            int current = scratch.queue[head];
+            for (int next : { current - 1, current - stride, current + stride, current + 1 }) {
+                if (scratch.distance[next] >= 0 || !scratch.open[next]) continue;
+                scratch.distance[next] = scratch.distance[current] + 1;
+                if (parents) scratch.parent[next] = current;
+                if (stop(next)) return;
+                scratch.queue.push_back(next);
+            }
+        }
+    }
+
+    void bfs(const Rect& r, int source, Scratch& scratch, bool parents) const {
+        bfs(r, source, scratch, parents, [](int) { return false; });
+    }
+
+    // Calls fn(node) for each entrance across a cluster border from cell.
+    template <class Fn>
+    void forEachCrossing(const Grid& grid, int cell, Fn&& fn) const {
+        int x = cell % width_, y = cell / width_;
+        auto cross = [&](int nx, int ny) {
+            if (nx < 0 || ny < 0 || nx >= width_ || ny >= height_ || grid.isWall(nx, ny)) return;
+            int other = ny * width_ + nx;
+            int node = nodeAt(clusterOf(other), other);
+            if (node >= 0) fn(node);
+        };
+        if (x % clusterSize_ == 0) cross(x - 1, y);
+        if (y % clusterSize_ == 0) cross(x, y - 1);
+        if ((y + 1) % clusterSize_ == 0) cross(x, y + 1);
+        if ((x + 1) % clusterSize_ == 0) cross(x + 1, y);
+    }
+
+    std::vector<Link> linkEndpoint(const Grid& grid, int cell, Scratch& scratch) const {
+        int cluster = clusterOf(cell);
+        Rect r = rect(cluster);
+        load(grid, r, scratch);
+        bfs(r, cell, scratch, false);
+        std::vector<Link> links;
+        const std::vector<int>& cells = clusters_[cluster].cells;
+        for (std::size_t i = 0; i < cells.size(); ++i) {
+            int d = scratch.distance[local(r, cells[i])];
+            if (d >= 0) links.push_back({ offset_[cluster] + static_cast<int>(i), d });
+        }
+        return links;
+    }
+
+    int distanceInCluster(const Grid& grid, int from, int to, Scratch& scratch) const {
+        Rect r = rect(clusterOf(from));
+        load(grid, r, scratch);
+        bfs(r, from, scratch, false);
+        return scratch.distance[local(r, to)];
+    }
+
+    // Appends the cells after from up to and including to.
+    void refine(const Grid& grid, int from, int to, std::vector<int>& path, Scratch& scratch) const {
+        Rect r = rect(clusterOf(from));
+        load(grid, r, scratch);
+        int target = local(r, to);
+        bfs(r, from, scratch, true, [target](int at) { return at == target; });
+        std::size_t mark = path.size();
+        for (int at = target; at != local(r, from); at = scratch.parent[at]) path.push_back(global(r, at));
+        std::reverse(path.begin() + mark, path.end());
+    }
+
+    int clusterSize_;
+    int width_ = 0, height_ = 0;
+    int clustersX_ = 0, clustersY_ = 0;
+    std::uint64_t gridId_ = 0, version_ = 0;
+    std::vector<Cluster> clusters_;
+    std::vector<int> offset_; // first node id of each cluster; back() is the node count
+};
+
+} // namespace Pathfinding
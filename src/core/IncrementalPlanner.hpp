@@ -0,0 +1,246 @@
+#pragma once
+
+#include "ComponentIndex.hpp"
+#include "Grid.hpp"
+#include "SearchObserver.hpp"
+#include "SearchResult.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <limits>
+#include <vector>
+
+namespace Pathfinding {
+
+// D* Lite: a shortest-path planner that keeps its search tree between calls.
+// Distances are kept toward the goal, so the start may move freely. When the
+// goal stays put, plan() reads the walls edited since the previous call from
+// the grid's journal and repairs only the part of the tree they affect;
+// unchanged edits and edits far from the path cost almost nothing.
+//
+// The planner starts from scratch whenever it cannot prove its state is
+// current: on first use, for a different grid or goal, or once the grid's
+// journal no longer covers the previous call. One planner serves one caller;
+// it is not safe to share between threads.
+class IncrementalPlanner {
+public:
+    // Finds a shortest 4-connected path from start to end. Observer events
+    // cover only the cells this call had to (re)process.
+    template <class Observer>
+    SearchResult plan(const Grid& grid, int start, int end, Observer& observer) {
+        // An unreachable goal leaves the tree as it is; the next call still
+        // catches up on the edits from the journal.
+        if (!ComponentIndex::shared(grid)->connected(start, end)) return {};
+
+        changed_.clear();
+        if (grid.id() != gridId_ || end != goal_ || !grid.changesSince(version_, changed_)) {
+            reset(grid, start, end, observer);
+            changed_.clear();
+        }
+        gridId_ = grid.id();
+        version_ = grid.version();
+
+        // Keys already queued stay valid lower bounds if km grows by the
+        // heuristic distance the start has moved.
+        km_ += manhattan(lastStart_, start);
+        start_ = start;
+        if (lastStart_ != start) {
+            // Like the other searches, the start counts as open even on a wall.
+            updateVertex(grid, lastStart_, observer);
+            updateVertex(grid, start, observer);
+            lastStart_ = start;
+        }
+
+        for (int cell : changed_) {
+            updateVertex(grid, cell, observer);
+            forEachNeighbour(cell, [&](int neighbour) { updateVertex(grid, neighbour, observer); });
+        }
+
+        computeShortestPath(grid, observer);
+        return extractPath(grid, observer);
+    }
+
+    // Forgets all state; the next plan() searches from scratch.
+    void invalidate() { gridId_ = 0; }
+
+private:
+    static constexpr int kInf = std::numeric_limits<int>::max();
+
+    struct Key {
+        int k1, k2;
+
+        bool operator<(const Key& other) const { return k1 != other.k1 ? k1 < other.k1 : k2 < other.k2; }
+        bool operator==(const Key& other) const { return k1 == other.k1 && k2 == other.k2; }
+    };
+
+    struct Entry {
+        Key key;
+        int index;
+
+        bool operator>(const Entry& other) const {
+            if (!(key == other.key)) return other.key < key;
+            return index > other.index;
+        }
+    };
+
+    template <class Observer>
+    void reset(const Grid& grid, int start, int goal, Observer& observer) {
+        width_ = grid.width();
+        height_ = grid.height();
+        std::size_t cells = grid.cellCount();
+        g_.assign(cells, kInf);
+        rhs_.assign(cells, kInf);
+        key_.resize(cells);
+        queued_.assign(cells, 0);
+        heap_.clear();
+        live_ = 0;
+        km_ = 0;
+        goal_ = goal;
+        start_ = lastStart_ = start;
+        rhs_[goal] = 0;
+        push(goal, calculateKey(goal), observer);
+    }
+
+    int manhattan(int a, int b) const {
+        return std::abs(a % width_ - b % width_) + std::abs(a / width_ - b / width_);
+    }
+
+    static int add(int a, int b) { return a == kInf || b == kInf ? kInf : a + b; }
+
+    Key calculateKey(int cell) const {
+        int m = std::min(g_[cell], rhs_[cell]);
+        if (m == kInf) return { kInf, kInf };
+        return { m + manhattan(start_, cell) + km_, m };
+    }
+
+    // Calls fn(neighbourIndex) for each in-bounds 4-neighbour, walls included;
+    // edge costs decide whether a step is allowed.
+    template <class Fn>
+    void forEachNeighbour(int index, Fn&& fn) const {
+        int x = index % width_, y = index / width_;
+        if (x > 0) fn(index - 1);
+        if (y > 0) fn(index - width_);
+        if (y + 1 < height_) fn(index + width_);
+        if (x + 1 < width_) fn(index + 1);
+    }
+
+    bool open(const Grid& grid, int index) const {
+        return !grid.isWall(index % width_, index / width_);
+    }
+
+    template <class Observer>
+    void push(int cell, Key key, Observer& observer) {
+        if (!queued_[cell]) ++live_;
+        queued_[cell] = 1;
+        key_[cell] = key;
+        heap_.push_back({ key, cell });
+        std::push_heap(heap_.begin(), heap_.end(), std::greater<Entry>());
+        observer.onVisit(cell);
+    }
+
+    void remove(int cell) {
+        // Lazy deletion: the heap entry is skipped when it surfaces.
+        if (queued_[cell]) --live_;
+        queued_[cell] = 0;
+    }
+
+    bool stale(const Entry& entry) const {
+        return !queued_[entry.index] || !(key_[entry.index] == entry.key);
+    }
+
+    // Pops stale entries off the top and rebuilds the heap once they make up
+    // most of it, so edits that requeue the same cells do not grow it forever.
+    void skipStale() {
+        if (heap_.size() > 1024 && heap_.size() > 4 * static_cast<std::size_t>(live_)) {
+            heap_.erase(std::remove_if(heap_.begin(), heap_.end(), [this](const Entry& entry) { return stale(entry); }), heap_.end());
+            std::make_heap(heap_.begin(), heap_.end(), std::greater<Entry>());
+        }
+        while (!heap_.empty() && stale(heap_.front())) {
+            std::pop_heap(heap_.begin(), heap_.end(), std::greater<Entry>());
+            heap_.pop_back();
+        }
+    }
+
+    template <class Observer>
+    void updateVertex(const Grid& grid, int cell, Observer& observer) {
+        if (cell != goal_) {
+            int best = kInf;
+            if (cell == start_ || open(grid, cell)) {
+                forEachNeighbour(cell, [&](int neighbour) {
+                    if (open(grid, neighbour)) best = std::min(best, add(g_[neighbour], 1));
+                    });
+            }
+            rhs_[cell] = best;
+        }
+        remove(cell);
+        if (g_[cell] != rhs_[cell]) push(cell, calculateKey(cell), observer);
+    }
+
+    template <class Observer>
+    void computeShortestPath(const Grid& grid, Observer& observer) {
+        while (true) {
+            skipStale();
+            if (heap_.empty()) break;
+            Entry top = heap_.front();
+            if (!(top.key < calculateKey(start_)) && rhs_[start_] == g_[start_]) break;
+
+            std::pop_heap(heap_.begin(), heap_.end(), std::greater<Entry>());
+            heap_.pop_back();
+            int cell = top.index;
+            Key fresh = calculateKey(cell);
+            if (top.key < fresh) {
+                push(cell, fresh, observer);
+                continue;
+            }
+            remove(cell);
+            observer.onExpand(cell);
+            if (g_[cell] > rhs_[cell]) {
+                g_[cell] = rhs_[cell];
+            }
+            else {
+                g_[cell] = kInf;
+                updateVertex(grid, cell, observer);
+            }
+            forEachNeighbour(cell, [&](int neighbour) { updateVertex(grid, neighbour, observer); });
+        }
+    }
+
+    // Follows the cheapest next step from the start; with consistent g values
+    // every step lowers the distance by one, so the walk ends at the goal.
+    template <class Observer>
+    SearchResult extractPath(const Grid& grid, Observer& observer) {
+        SearchResult result;
+        if (g_[start_] == kInf) return result;
+
+        result.path.push_back(start_);
+        for (int cell = start_; cell != goal_;) {
+            int next = -1;
+            forEachNeighbour(cell, [&](int neighbour) {
+                if (open(grid, neighbour) && g_[neighbour] != kInf && (next == -1 || g_[neighbour] < g_[next])) next = neighbour;
+                });
+            if (next == -1 || g_[next] >= g_[cell]) return {};
+            result.path.push_back(next);
+            cell = next;
+        }
+        result.found = true;
+        for (auto it = result.path.rbegin(); it != result.path.rend() - 1; ++it) observer.onPath(*it);
+        return result;
+    }
+
+    std::uint64_t gridId_ = 0;
+    std::uint64_t version_ = 0;
+    int width_ = 0, height_ = 0;
+    int goal_ = -1, start_ = -1, lastStart_ = -1;
+    int km_ = 0;
+
+    std::vector<int> g_, rhs_;          // distance to the goal and its one-step lookahead
+    std::vector<Key> key_;              // key of each cell's live heap entry
+    std::vector<std::uint8_t> queued_;  // 1 while a cell has a live heap entry
+    std::vector<Entry> heap_;
+    int live_ = 0;                      // cells with a live heap entry
+    std::vector<int> changed_;          // scratch for the grid's change journal
+};
+
+} // namespace Pathfinding
@@ -0,0 +1,318 @@
+#pragma once
+
+#include "Grid.hpp"
+#include "SearchArena.hpp"
+#include "SearchObserver.hpp"
+#include "SearchResult.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Pathfinding {
+
+// Jump Point Search for 4-connected uniform-cost grids.
+//
+// Among equal-length paths the canonical one turns vertical as early as
+// possible. A horizontal move therefore only continues forwards, plus up/down
+// where the cell diagonally behind is blocked (a forced neighbour). A vertical
+// move may continue or turn either way, so a vertical jump stops wherever a
+// horizontal jump from it would find something. Jump points are searched with
+// A* over Manhattan distance and return paths of the same optimal length.
+
+enum JumpDirection { JumpEast, JumpWest, JumpSouth, JumpNorth, JumpDirectionCount };
+
+// JPS+ preprocessing: for every open cell and direction, the distance of the
+// jump made from it when the goal is not involved. A positive value d means the
+// jump stops at a jump point d cells away; zero or a negative value -d means
+// the jump runs into a wall after d open cells. Costs 16 bytes per cell.
+class JumpTable {
+public:
+    explicit JumpTable(const Grid& grid) {
+        int width = grid.width(), height = grid.height();
+        for (auto& table : distances_) table.assign(grid.cellCount(), 0);
+
+        // Horizontal runs only depend on their own row and its neighbours.
+        for (int y = 0; y < height; ++y) {
+            for (int x = width - 2; x >= 0; --x) {
+                distances_[JumpEast][grid.index(x, y)] = step(grid, x, y, x + 1, y, JumpEast);
+            }
+            for (int x = 1; x < width; ++x) {
+                distances_[JumpWest][grid.index(x, y)] = step(grid, x, y, x - 1, y, JumpWest);
+            }
+        }
+        // Vertical runs stop where a horizontal jump succeeds, so they come second.
+        for (int x = 0; x < width; ++x) {
+            for (int y = height - 2; y >= 0; --y) {
+                distances_[JumpSouth][grid.index(x, y)] = step(grid, x, y, x, y + 1, JumpSouth);
+            }
+            for (int y = 1; y < height; ++y) {
+                distances_[JumpNorth][grid.index(x, y)] = step(grid, x, y, x, y - 1, JumpNorth);
+            }
+        }
+    }
+
+    int distance(int index, JumpDirection dir) const { return distances_[dir][index]; }
+
+    // Whether moving horizontally by dx into (x, y) exposes a cell above or below
+    // that could not have been reached earlier by turning one column back.
+    static bool hasForcedNeighbour(const Grid& grid, int x, int y, int dx) {
+        auto open = [&](int cx, int cy) { return grid.inBounds(cx, cy) && !grid.isWall(cx, cy); };
+        return (open(x, y - 1) && !open(x - dx, y - 1)) || (open(x, y + 1) && !open(x - dx, y + 1));
+    }
+
+    // Table for the grid's current contents, rebuilt only when the grid changed
+    // since the last call. Shared by every thread; the returned pointer stays
+    // valid for as long as the caller holds it.
+    static std::shared_ptr<const JumpTable> shared(const Grid& grid) {
+        static std::mutex mutex;
+        static std::shared_ptr<const JumpTable> cached;
+        static std::uint64_t cachedId = 0, cachedVersion = 0;
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!cached || cachedId != grid.id() || cachedVersion != grid.version()) {
+            cached = std::make_shared<const JumpTable>(grid);
+            cachedId = grid.id();
+            cachedVersion = grid.version();
+        }
+        return cached;
+    }
+
+private:
+    // Distance from (x, y) when the next cell in the direction is (nx, ny).
+    int step(const Grid& grid, int x, int y, int nx, int ny, JumpDirection dir) const {
+        if (grid.isWall(x, y) || grid.isWall(nx, ny)) return 0;
+
+        int next = grid.index(nx, ny);
+        bool stops = (dir == JumpEast || dir == JumpWest)
+            ? hasForcedNeighbour(grid, nx, ny, nx - x)
+            : distances_[JumpEast][next] > 0 || distances_[JumpWest][next] > 0;
+        if (stops) return 1;
+
+        int rest = distances_[dir][next];
+        return rest > 0 ? rest + 1 : rest - 1;
+    }
+
+    std::vector<int> distances_[JumpDirectionCount];
+};
+
+class JumpPointSearch {
+public:
+    // Scans the grid online when table is null, otherwise jumps in O(1) using the JPS+ table.
+    template <class Observer>
+    static SearchResult search(const Grid& grid, int start, int end, const JumpTable* table, Observer& observer) {
+        SearchArena arena;
+        return search(grid, start, end, table, observer, arena);
+    }
+
+    // Ties on f go to the node with the larger g: on open maps many jump points
+    // share an f value, and preferring the deeper one heads straight for the goal.
+    template <class Observer>
+    static SearchResult search(const Grid& grid, int start, int end, const JumpTable* table, Observer& observer, SearchArena& arena) {
+        Jumper jumper{ grid, table, grid.point(end) };
+
+        arena.begin(grid.cellCount());
+        OpenList& openSet = arena.open;
+
+        arena.reach(start, 0, -1);
+        openSet.push({ manhattan(grid, start, end), 0, start });
+        observer.onPhase(SearchPhase::Search);
+
+        while (!openSet.empty()) {
+            int current = openSet.top().index;
+            int g = -openSet.top().tie;
+            openSet.pop();
+            observer.onPop(current);
+
+            if (current == end) {
+                observer.onPhase(SearchPhase::Reconstruct);
+                return reconstructPath(grid, arena, start, end, observer);
+            }
+            if (g > arena.cost(current)) {
+                observer.onStale(current);
+                continue;
+            }
+            observer.onExpand(current);
+
+            Point p = grid.point(current);
+            Point from = arena.parent(current) == -1 ? p : grid.point(arena.parent(current));
+            int dx = sign(p.x - from.x), dy = sign(p.y - from.y);
+
+            auto tryJump = [&](int jdx, int jdy) {
+                int next = jumper.jump(p.x, p.y, jdx, jdy);
+                if (next == -1) return;
+                observer.onGenerate(next);
+
+                int tentativeG = g + manhattan(grid, current, next);
+                if (tentativeG < arena.cost(next)) {
+                    arena.reach(next, tentativeG, current);
+                    openSet.push({ tentativeG + manhattan(grid, next, end), -tentativeG, next });
+                    observer.onVisit(next);
+                    if constexpr (Observer::enabled) observer.onOpenSize(openSet.size());
+                }
+                };
+
+            if (dx == 0 && dy == 0) {
+                tryJump(-1, 0);
+                tryJump(0, -1);
+                tryJump(0, 1);
+                tryJump(1, 0);
+            }
+            else if (dy == 0) {
+                tryJump(dx, 0);
+                if (isOpen(grid, p.x, p.y - 1) && !isOpen(grid, p.x - dx, p.y - 1)) tryJump(0, -1);
+                if (isOpen(grid, p.x, p.y + 1) && !isOpen(grid, p.x - dx, p.y + 1)) tryJump(0, 1);
+            }
+            else {
+                tryJump(0, dy);
+                tryJump(-1, 0);
+                tryJump(1, 0);
+            }
+        }
+        return {};
+    }
+
+private:
+    struct Jumper {
+        const Grid& grid;
+        const JumpTable* table;
+        Point goal;
+
+        // Next jump point from (x, y) in direction (dx, dy), or -1 when the jump dead-ends.
+        int jump(int x, int y, int dx, int dy) const {
+            if (table) return dy == 0 ? tableJumpHorizontal(x, y, dx) : tableJumpVertical(x, y, dy);
+            return dy == 0 ? scanHorizontal(x, y, dx) : scanVertical(x, y, dy);
+        }
+
+        // Works a 64-cell word at a time on the wall bitmap: a jump stops at the
+        // first goal or forced-neighbour bit unless a wall bit comes first.
+        int scanHorizontal(int x, int y, int dx) const {
+            const std::uint64_t* row = grid.row(y);
+            const std::uint64_t* above = y > 0 ? grid.row(y - 1) : nullptr;
+            const std::uint64_t* below = y + 1 < grid.height() ? grid.row(y + 1) : nullptr;
+
+            for (int k = (x + dx) >> 6; k >= 0 && k < grid.wordsPerRow(); k += dx) {
+                std::uint64_t walls = wallWord(row, k);
+                std::uint64_t stops = forcedBits(above, k, dx) | forcedBits(below, k, dx);
+                if (y == goal.y && (goal.x >> 6) == k) stops |= std::uint64_t(1) << (goal.x & 63);
+
+                // Only cells strictly past x count.
+                std::uint64_t candidates = walls | stops;
+                if (k == (x >> 6)) {
+                    int bit = x & 63;
+                    candidates &= dx > 0 ? (bit == 63 ? 0 : ~std::uint64_t(0) << (bit + 1))
+                                         : (std::uint64_t(1) << bit) - 1;
+                }
+                if (!candidates) continue;
+
+                int bit = dx > 0 ? lowestBit(candidates) : highestBit(candidates);
+                if ((walls >> bit) & 1) return -1;
+                return grid.index(k * 64 + bit, y);
+            }
+            return -1;
+        }
+
+        // Wall bits of word k in a row, with cells outside the grid reported as walls.
+        std::uint64_t wallWord(const std::uint64_t* row, int k) const {
+            if (!row || k < 0 || k >= grid.wordsPerRow()) return ~std::uint64_t(0);
+            int valid = grid.width() - k * 64;
+            return valid >= 64 ? row[k] : row[k] | (~std::uint64_t(0) << valid);
+        }
+
+        // Cells of word k in the row next to the scanned one that are open while
+        // the cell one step back (against dx) is blocked.
+        std::uint64_t forcedBits(const std::uint64_t* row, int k, int dx) const {
+            if (!row) return 0;
+            std::uint64_t walls = wallWord(row, k);
+            std::uint64_t behind = dx > 0 ? (walls << 1) | (wallWord(row, k - 1) >> 63)
+                                          : (walls >> 1) | (wallWord(row, k + 1) << 63);
+            return ~walls & behind;
+        }
+
+        int scanVertical(int x, int y, int dy) const {
+            while (true) {
+                y += dy;
+                if (!isOpen(grid, x, y)) return -1;
+                if (x == goal.x && y == goal.y) return grid.index(x, y);
+                if (scanHorizontal(x, y, 1) != -1 || scanHorizontal(x, y, -1) != -1) return grid.index(x, y);
+            }
+        }
+
+        int tableJumpHorizontal(int x, int y, int dx) const {
+            int d = table->distance(grid.index(x, y), dx > 0 ? JumpEast : JumpWest);
+            int reach = std::abs(d);
+            if (y == goal.y && (goal.x - x) * dx > 0 && std::abs(goal.x - x) <= reach) return grid.index(goal.x, goal.y);
+            return d > 0 ? grid.index(x + dx * d, y) : -1;
+        }
+
+        int tableJumpVertical(int x, int y, int dy) const {
+            int d = table->distance(grid.index(x, y), dy > 0 ? JumpSouth : JumpNorth);
+            int reach = std::abs(d);
+            // The only goal-dependent stop in the scanned column is on the goal's row.
+            if ((goal.y - y) * dy > 0 && std::abs(goal.y - y) <= reach) {
+                int row = grid.index(x, goal.y);
+                if (x == goal.x) return row;
+                int dx = goal.x > x ? 1 : -1;
+                int across = table->distance(row, dx > 0 ? JumpEast : JumpWest);
+                if (std::abs(goal.x - x) <= std::abs(across)) return row;
+            }
+            return d > 0 ? grid.index(x, y + dy * d) : -1;
+        }
+    };
+
+    static bool isOpen(const Grid& grid, int x, int y) { return grid.inBounds(x, y) && !grid.isWall(x, y); }
+
+    static int lowestBit(std::uint64_t v) {
+#if defined(_MSC_VER)
+        unsigned long bit;
+        _BitScanForward64(&bit, v);
+        return static_cast<int>(bit);
+#else
+        return __builtin_ctzll(v);
+#endif
+    }
+
+    static int highestBit(std::uint64_t v) {
+#if defined(_MSC_VER)
+        unsigned long bit;
+        _BitScanReverse64(&bit, v);
+        return static_cast<int>(bit);
+#else
+        return 63 - __builtin_clzll(v);
+#endif
+    }
+    static int sign(int v) { return (v > 0) - (v < 0); }
+
+    static int manhattan(const Grid& grid, int a, int b) {
+        int w = grid.width();
+        return std::abs(a % w - b % w) + std::abs(a / w - b / w);
+    }
+
+    // Expands the chain of jump points into the straight runs of cells between them.
+    template <class Observer>
+    static SearchResult reconstructPath(const Grid& grid, const SearchArena& arena, int start, int end, Observer& observer) {
+        SearchResult result;
+        result.found = true;
+
+        for (int current = end; current != start; current = arena.parent(current)) {
+            Point p = grid.point(current), q = grid.point(arena.parent(current));
+            int dx = sign(q.x - p.x), dy = sign(q.y - p.y);
+            for (; p != q; p.x += dx, p.y += dy) {
+                int index = grid.index(p.x, p.y);
+                result.path.push_back(index);
+                observer.onPath(index);
+            }
+        }
+        result.path.push_back(start);
+        std::reverse(result.path.begin(), result.path.end());
+        return result;
+    }
+};
+
+} // namespace Pathfinding
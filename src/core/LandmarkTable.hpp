@@ -0,0 +1,358 @@
+#pragma once
+
+#include "ComponentIndex.hpp"
+#include "Grid.hpp"
+#include "SearchArena.hpp"
+#include "SearchKernel.hpp"
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Pathfinding {
+
+// Exact 4-connected distances from a few landmark cells, for the ALT heuristic
+// (A*, landmarks, triangle inequality). Landmarks are spread around the border
+// of the largest component, and their distance fields are computed in parallel,
+// one Dijkstra per landmark. Distances are stored cell-major, so the heuristic
+// reads one run of count() values per cell.
+//
+// Building the table costs count() full Dijkstra runs, so shared() can also
+// keep it on disk under a hash of the map's walls and costs, and a later run
+// on the same map loads it instead. Tables stay in memory only unless the
+// caller picks a directory with setCacheDirectory().
+class LandmarkTable {
+public:
+    static constexpr int kDefaultLandmarks = 8;
+    static constexpr std::uint32_t kUnreachable = 0xffffffffu;
+    static constexpr std::uintmax_t kDefaultCacheBytes = std::uintmax_t(1) << 30;
+
+    LandmarkTable() = default;
+
+    explicit LandmarkTable(const Grid& grid, int count = kDefaultLandmarks, ThreadPool* pool = nullptr) {
+        build(grid, count, pool);
+    }
+
+    int count() const { return static_cast<int>(landmarks_.size()); }
+    const std::vector<int>& landmarks() const { return landmarks_; }
+    // Identifies the map contents and landmark count the table was built for.
+    std::uint64_t key() const { return key_; }
+
+    // Distance from each landmark to cell, count() values; kUnreachable where
+    // the cell lies in another component.
+    const std::uint32_t* distances(int cell) const { return distances_.data() + static_cast<std::size_t>(cell) * landmarks_.size(); }
+
+    // Key for a grid's walls and costs combined with a landmark count. Grids
+    // with equal contents get equal keys, whatever their id() and version().
+    static std::uint64_t key(const Grid& grid, int count) {
+        std::uint64_t h = 0xcbf29ce484222325ull;
+        auto mix = [&](std::uint64_t word) { h = (h ^ word) * 0x100000001b3ull; h ^= h >> 29; };
+        mix(static_cast<std::uint64_t>(grid.width()) << 32 | static_cast<std::uint32_t>(grid.height()));
+        mix(static_cast<std::uint64_t>(count));
+        for (int y = 0; y < grid.height(); ++y) {
+            const std::uint64_t* row = grid.row(y);
+            for (int i = 0; i < grid.wordsPerRow(); ++i) mix(row[i]);
+        }
+        if (grid.weighted()) {
+            // Sixteen 4-bit costs per word.
+            std::uint64_t word = 0;
+            for (int cell = 0; cell < grid.cellCount(); ++cell) {
+                word = word << 4 | static_cast<std::uint64_t>(grid.cost(cell));
+                if (cell % 16 == 15) mix(std::exchange(word, 0));
+            }
+            mix(word);
+        }
+        return h;
+    }
+
+    // File layout, native byte order: "PFLM", format version, key, width,
+    // height, landmark count, bytes per distance (2 when every finite distance
+    // fits below 0xffff, else 4), the landmark cells, then the distances.
+    bool save(const std::string& path) const {
+        bool narrow = std::all_of(distances_.begin(), distances_.end(),
+            [](std::uint32_t d) { return d == kUnreachable || d < 0xffff; });
+        Header header{ { 'P', 'F', 'L', 'M' }, kFormatVersion, key_, width_, height_, count(), narrow ? 2 : 4 };
+
+        // Written beside the target and renamed, so a reader never sees half a file.
+        std::string temporary = path + ".tmp";
+        {
+            std::ofstream out(temporary, std::ios::binary);
+            if (!out) return false;
+            out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            out.write(reinterpret_cast<const char*>(landmarks_.data()), landmarks_.size() * sizeof(int));
+            if (narrow) {
+                std::vector<std::uint16_t> packed(distances_.size());
+                for (std::size_t i = 0; i < packed.size(); ++i) {
+                    packed[i] = distances_[i] == kUnreachable ? 0xffff : static_cast<std::uint16_t>(distances_[i]);
+                }
+                out.write(reinterpret_cast<const char*>(packed.data()), packed.size() * sizeof(std::uint16_t));
+            }
+            else {
+                out.write(reinterpret_cast<const char*>(distances_.data()), distances_.size() * sizeof(std::uint32_t));
+            }
+            if (!out) return false;
+        }
+        std::error_code error;
+        std::filesystem::rename(temporary, path, error);
+        return !error;
+    }
+
+    // Reads a table saved for the given key and grid size. Fails on a missing,
+    // damaged or mismatched file and leaves table untouched.
+    static bool load(const std::string& path, std::uint64_t key, int width, int height, LandmarkTable& table) {
+        std::ifstream in(path, std::ios::binary);
+        Header header;
+        if (!in.read(reinterpret_cast<char*>(&header), sizeof(header))) return false;
+        if (std::string(header.magic, 4) != "PFLM" || header.format != kFormatVersion || header.key != key) return false;
+        if (header.width != width || header.height != height || header.count < 0 || (header.bytes != 2 && header.bytes != 4)) return false;
+
+        LandmarkTable loaded;
+        loaded.key_ = key;
+        loaded.width_ = header.width;
+        loaded.height_ = header.height;
+        loaded.landmarks_.resize(header.count);
+        std::size_t size = static_cast<std::size_t>(header.width) * header.height * header.count;
+        loaded.distances_.resize(size);
+        if (!in.read(reinterpret_cast<char*>(loaded.landmarks_.data()), header.count * sizeof(int))) return false;
+        for (int landmark : loaded.landmarks_) {
+            if (landmark < 0 || static_cast<std::size_t>(landmark) >= static_cast<std::size_t>(width) * height) return false;
+        }
+        if (header.bytes == 2) {
+            std::vector<std::uint16_t> packed(size);
+            if (!in.read(reinterpret_cast<char*>(packed.data()), size * sizeof(std::uint16_t))) return false;
+            for (std::size_t i = 0; i < size; ++i) loaded.distances_[i] = packed[i] == 0xffff ? kUnreachable : packed[i];
+        }
+        else if (!in.read(reinterpret_cast<char*>(loaded.distances_.data()), size * sizeof(std::uint32_t))) {
+            return false;
+        }
+        table = std::move(loaded);
+        return true;
+    }
+
+    // Where shared() keeps tables between runs, and how many bytes of tables
+    // it may keep there; past that, the least recently used are deleted. An
+    // empty path, the default, keeps tables in memory only.
+    static void setCacheDirectory(const std::string& directory, std::uintmax_t maxBytes = kDefaultCacheBytes) {
+        std::lock_guard<std::mutex> lock(cacheMutex());
+        cacheDirectory() = directory;
+        cacheLimit() = maxBytes;
+    }
+
+    // Table for the grid's current contents, shared by every thread. After an
+    // edit it is loaded from the cache directory when a table for the new
+    // contents is there, and built and saved otherwise.
+    static std::shared_ptr<const LandmarkTable> shared(const Grid& grid) {
+        static std::shared_ptr<const LandmarkTable> cached;
+        static std::uint64_t cachedId = 0, cachedVersion = 0;
+
+        std::lock_guard<std::mutex> lock(cacheMutex());
+        if (cached && cachedId == grid.id() && cachedVersion == grid.version()) return cached;
+
+        std::uint64_t wanted = key(grid, kDefaultLandmarks);
+        if (!cached || cached->key_ != wanted) {
+            auto table = std::make_shared<LandmarkTable>();
+            std::string path;
+            if (!cacheDirectory().empty()) {
+                char name[32];
+                std::snprintf(name, sizeof(name), "%016llx.alt", static_cast<unsigned long long>(wanted));
+                path = (std::filesystem::path(cacheDirectory()) / name).string();
+            }
+            std::error_code error;
+            if (!path.empty() && load(path, wanted, grid.width(), grid.height(), *table)) {
+                // Loading counts as a use, so the table is evicted last.
+                std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), error);
+            }
+            else {
+                table->build(grid, kDefaultLandmarks, &ThreadPool::shared());
+                if (!path.empty()) {
+                    std::filesystem::create_directories(cacheDirectory(), error);
+                    if (table->save(path)) trimCache(path);
+                }
+            }
+            cached = std::move(table);
+        }
+        cachedId = grid.id();
+        cachedVersion = grid.version();
+        return cached;
+    }
+
+private:
+    static constexpr std::uint32_t kFormatVersion = 1;
+
+    struct Header {
+        char magic[4];
+        std::uint32_t format;
+        std::uint64_t key;
+        std::int32_t width, height, count, bytes;
+    };
+
+    static std::mutex& cacheMutex() {
+        static std::mutex mutex;
+        return mutex;
+    }
+
+    static std::string& cacheDirectory() {
+        static std::string directory;
+        return directory;
+    }
+
+    static std::uintmax_t& cacheLimit() {
+        static std::uintmax_t limit = kDefaultCacheBytes;
+        return limit;
+    }
+
+    // Deletes the least recently written tables in the cache directory until
+    // the rest fit within the limit, sparing the one just saved.
+    static void trimCache(const std::string& keep) {
+        std::error_code error;
+        std::vector<std::pair<std::filesystem::file_time_type, std::filesystem::path>> files;
+        std::uintmax_t total = 0;
+        for (const auto& entry : std::filesystem::directory_iterator(cacheDirectory(), error)) {
+            if (entry.path().extension() != ".alt") continue;
+            std::uintmax_t size = entry.file_size(error);
+            if (error) continue;
+            total += size;
+            if (entry.path() != std::filesystem::path(keep)) files.push_back({ entry.last_write_time(error), entry.path() });
+        }
+        std::sort(files.begin(), files.end());
+        for (const auto& file : files) {
+            if (total <= cacheLimit()) break;
+            std::uintmax_t size = std::filesystem::file_size(file.second, error);
+            if (!error && std::filesystem::remove(file.second, error)) total -= size;
+        }
+    }
+
+    void build(const Grid& grid, int count, ThreadPool* pool) {
+        key_ = key(grid, count);
+        width_ = grid.width();
+        height_ = grid.height();
+        landmarks_ = pickLandmarks(grid, count);
+
+        std::vector<std::vector<std::uint32_t>> fields(landmarks_.size());
+        auto fill = [&](std::size_t i, unsigned) { distanceField(grid, landmarks_[i], fields[i]); };
+        if (pool) pool->parallelFor(fields.size(), fill);
+        else for (std::size_t i = 0; i < fields.size(); ++i) fill(i, 0);
+
+        std::size_t k = landmarks_.size();
+        distances_.resize(static_cast<std::size_t>(grid.cellCount()) * k);
+        for (std::size_t cell = 0; cell < static_cast<std::size_t>(grid.cellCount()); ++cell) {
+            for (std::size_t i = 0; i < k; ++i) distances_[cell * k + i] = fields[i][cell];
+        }
+    }
+
+    // Walks inward from count points spaced evenly around the border and takes
+    // the first cell of the largest component on each line. Landmarks far out
+    // at different sides bound the most queries well.
+    static std::vector<int> pickLandmarks(const Grid& grid, int count) {
+        int w = grid.width(), h = grid.height();
+        auto components = ComponentIndex::shared(grid);
+        std::vector<int> sizes;
+        for (int cell = 0; cell < grid.cellCount(); ++cell) {
+            int c = components->component(cell);
+            if (c < 0) continue;
+            if (c >= static_cast<int>(sizes.size())) sizes.resize(c + 1, 0);
+            ++sizes[c];
+        }
+        std::vector<int> landmarks;
+        if (sizes.empty()) return landmarks;
+        int largest = static_cast<int>(std::max_element(sizes.begin(), sizes.end()) - sizes.begin());
+
+        long long perimeter = std::max(1LL, 2LL * (w - 1) + 2LL * (h - 1));
+        for (int i = 0; i < count; ++i) {
+            long long along = (2 * i + 1) * perimeter / (2 * count);
+            int bx, by;
+            if (along < w - 1) { bx = static_cast<int>(along); by = 0; }
+            else if ((along -= w - 1) < h - 1) { bx = w - 1; by = static_cast<int>(along); }
+            else if ((along -= h - 1) < w - 1) { bx = w - 1 - static_cast<int>(along); by = h - 1; }
+            else { bx = 0; by = std::max(0, h - 1 - static_cast<int>(along - (w - 1))); }
+
+            int cx = w / 2, cy = h / 2;
+            int steps = std::max(std::abs(cx - bx), std::abs(cy - by));
+            for (int s = 0; s <= steps; ++s) {
+                int x = steps ? bx + (cx - bx) * s / steps : bx;
+                int y = steps ? by + (cy - by) * s / steps : by;
+                int cell = grid.index(x, y);
+                if (components->component(cell) != largest) continue;
+                if (std::find(landmarks.begin(), landmarks.end(), cell) == landmarks.end()) landmarks.push_back(cell);
+                break;
+            }
+        }
+        return landmarks;
+    }
+
+    // Dijkstra over 4-connected moves, paying the cost of each cell entered.
+    static void distanceField(const Grid& grid, int source, std::vector<std::uint32_t>& field) {
+        field.assign(grid.cellCount(), kUnreachable);
+        BucketQueue queue;
+        queue.reset(Grid::kMaxCost + 1, 0);
+        field[source] = 0;
+        queue.push(0, { source, 0 });
+        while (!queue.empty()) {
+            int d;
+            BucketQueue::Entry entry = queue.pop(d);
+            if (static_cast<std::uint32_t>(d) > field[entry.index]) continue;
+            Neighbours<FourConnected>::forEach(grid, entry.index, [&](int next, int) {
+                int tentative = d + grid.cost(next);
+                if (static_cast<std::uint32_t>(tentative) < field[next]) {
+                    field[next] = tentative;
+                    queue.push(tentative, { next, tentative });
+                }
+                });
+        }
+    }
+
+    std::uint64_t key_ = 0;
+    int width_ = 0, height_ = 0;
+    std::vector<int> landmarks_;
+    std::vector<std::uint32_t> distances_; // cell-major, count() per cell
+};
+
+// ALT heuristic for one goal. With d the distances from a landmark L, and a
+// step paying the cost of the cell it enters, the triangle inequality gives two
+// lower bounds on the cost from n to the goal t:
+//   d(t) - d(n)                             going round L from the start side
+//   d(n) - cost(n) - (d(t) - cost(t))       since the cost from x to L is d(x) - cost(x) + cost(L)
+// The estimate is the largest bound over all landmarks, and never less than
+// the Manhattan distance. Differences of exact distances are consistent, so
+// A* stays optimal.
+class LandmarkHeuristic {
+public:
+    LandmarkHeuristic(const LandmarkTable& table, const Grid& grid, int goal)
+        : table_(table), goal_(table.distances(goal)), goalCost_(grid.cost(goal)) {}
+
+    template <class Moves>
+    int between(const Grid& grid, int cell, int goal) const {
+        static_assert(std::is_same<Moves, FourConnected>::value, "landmark distances are 4-connected");
+        int w = grid.width();
+        int best = std::abs(cell % w - goal % w) + std::abs(cell / w - goal / w);
+        const std::uint32_t* here = table_.distances(cell);
+        int costDelta = goalCost_ - grid.cost(cell);
+        for (int i = 0; i < table_.count(); ++i) {
+            if (here[i] == LandmarkTable::kUnreachable || goal_[i] == LandmarkTable::kUnreachable) continue;
+            int ahead = static_cast<int>(goal_[i]) - static_cast<int>(here[i]);
+            best = std::max(best, std::max(ahead, costDelta - ahead));
+        }
+        return best;
+    }
+
+    // Each bound moves by at most the cost of one cell per step.
+    template <class Moves>
+    static constexpr int maxRise() { return Grid::kMaxCost; }
+
+private:
+    const LandmarkTable& table_;
+    const std::uint32_t* goal_;
+    int goalCost_;
+};
+
+} // namespace Pathfinding
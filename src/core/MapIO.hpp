@@ -0,0 +1,180 @@
+#pragma once
+
+#include "Grid.hpp"
+#include "MappedFile.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+namespace Pathfinding {
+
+// One query from a MovingAI .scen file. optimal is the reference path length
+// with straight steps costing 1 and diagonal steps sqrt(2), without corner
+// cutting.
+struct Scenario {
+    int bucket = 0;
+    std::string map;  // as written in the file, usually relative to a maps directory
+    int width = 0, height = 0;
+    Point start, goal;
+    double optimal = 0.0;
+};
+
+// Map and scenario files. Plain-text maps have one line per row, '#' or '@'
+// for walls and any other character for open cells; rows shorter than the
+// widest one are padded open. MovingAI maps and scenarios are the standard
+// game and city benchmark sets.
+class MapIO {
+public:
+    static Grid loadAsciiMap(const std::string& path) {
+        std::ifstream in(path);
+        if (!in) throw std::runtime_error("Cannot open map file: " + path);
+
+        std::vector<std::string> rows;
+        std::string line;
+        std::size_t width = 0;
+        while (std::getline(in, line)) {
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            width = std::max(width, line.size());
+            rows.push_back(line);
+        }
+        if (rows.empty() || width == 0) throw std::runtime_error("Empty map file: " + path);
+
+        Grid grid(static_cast<int>(width), static_cast<int>(rows.size()));
+        for (int y = 0; y < grid.height(); ++y) {
+            const std::string& row = rows[y];
+            for (int x = 0; x < static_cast<int>(row.size()); ++x) {
+                grid.setWall(x, y, row[x] == '#' || row[x] == '@');
+            }
+        }
+        return grid;
+    }
+
+    // MovingAI benchmark maps (movingai.com/benchmarks): a header of "type",
+    // "height" and "width" lines ended by "map", then one line per row. '.',
+    // 'G' and 'S' are open; every other terrain ('@', 'O', 'T', 'W') is a
+    // wall. The file is memory-mapped and each row is packed straight into the
+    // grid's wall words, so maps of millions of cells load in one pass.
+    static Grid loadMovingAIMap(const std::string& path) {
+        MappedFile file(path);
+        Reader in(file);
+        auto fail = [&](const char* what) { return std::runtime_error(std::string(what) + " in map file: " + path); };
+
+        int width = 0, height = 0;
+        for (std::string_view line; in.line(line);) {
+            std::string_view key = word(line);
+            if (key == "map") break;
+            if (key == "height" && !number(word(line), height)) throw fail("Bad height");
+            if (key == "width" && !number(word(line), width)) throw fail("Bad width");
+        }
+        if (width <= 0 || height <= 0) throw fail("Missing size");
+
+        Grid grid(width, height);
+        std::vector<std::uint64_t> words(grid.wordsPerRow());
+        for (int y = 0; y < height; ++y) {
+            std::string_view row;
+            if (!in.line(row) || static_cast<int>(row.size()) < width) throw fail("Short row");
+            std::fill(words.begin(), words.end(), 0);
+            for (int x = 0; x < width; ++x) {
+                char c = row[x];
+                if (c != '.' && c != 'G' && c != 'S') words[x >> 6] |= std::uint64_t(1) << (x & 63);
+            }
+            grid.setRow(y, words.data());
+        }
+        return grid;
+    }
+
+    // MovingAI scenario files: a "version" line, then one query per line as
+    // bucket, map, map width, map height, start x, start y, goal x, goal y and
+    // optimal length, separated by whitespace.
+    static std::vector<Scenario> loadScenarios(const std::string& path) {
+        MappedFile file(path);
+        Reader in(file);
+
+        std::vector<Scenario> scenarios;
+        for (std::string_view line; in.line(line);) {
+            std::string_view first = word(line);
+            if (first.empty() || first == "version") continue;
+
+            Scenario scenario;
+            std::string_view map = word(line);
+            scenario.map.assign(map.data(), map.size());
+            if (!number(first, scenario.bucket) || map.empty() || !number(word(line), scenario.width) ||
+                !number(word(line), scenario.height) || !number(word(line), scenario.start.x) ||
+                !number(word(line), scenario.start.y) || !number(word(line), scenario.goal.x) ||
+                !number(word(line), scenario.goal.y) || !number(word(line), scenario.optimal)) {
+                throw std::runtime_error("Bad scenario on line " + std::to_string(in.lineNumber()) + " of " + path);
+            }
+            scenarios.push_back(std::move(scenario));
+        }
+        return scenarios;
+    }
+
+    static void saveAsciiMap(const Grid& grid, const std::string& path) {
+        std::ofstream out(path);
+        if (!out) throw std::runtime_error("Cannot write map file: " + path);
+
+        std::string row(grid.width(), '.');
+        for (int y = 0; y < grid.height(); ++y) {
+            for (int x = 0; x < grid.width(); ++x) row[x] = grid.isWall(x, y) ? '#' : '.';
+            out << row << '\n';
+        }
+    }
+
+private:
+    // Hands out the lines of a mapped file without copying them, with any
+    // trailing '\r' removed.
+    class Reader {
+    public:
+        explicit Reader(const MappedFile& file)
+            : pos_(reinterpret_cast<const char*>(file.data())), end_(pos_ + file.size()) {}
+
+        bool line(std::string_view& line) {
+            if (pos_ == end_) return false;
+            const char* begin = pos_;
+            const char* newline = std::find(pos_, end_, '\n');
+            pos_ = newline == end_ ? end_ : newline + 1;
+            if (newline != begin && newline[-1] == '\r') --newline;
+            line = std::string_view(begin, newline - begin);
+            ++lineNumber_;
+            return true;
+        }
+
+        int lineNumber() const { return lineNumber_; }
+
+    private:
+        const char* pos_;
+        const char* end_;
+        int lineNumber_ = 0;
+    };
+
+    // Takes the next whitespace-separated word off the front of line.
+    static std::string_view word(std::string_view& line) {
+        std::size_t begin = line.find_first_not_of(" \t");
+        if (begin == std::string_view::npos) {
+            line = {};
+            return {};
+        }
+        std::size_t end = std::min(line.find_first_of(" \t", begin), line.size());
+        std::string_view result = line.substr(begin, end - begin);
+        line.remove_prefix(end);
+        return result;
+    }
+
+    template <class T>
+    static bool number(std::string_view text, T& value) {
+        if (text.empty()) return false;
+        std::from_chars_result parsed = std::from_chars(text.data(), text.data() + text.size(), value);
+        return parsed.ec == std::errc() && parsed.ptr == text.data() + text.size();
+    }
+};
+
+} // namespace Pathfinding
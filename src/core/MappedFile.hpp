@@ -0,0 +1,140 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Pathfinding {
+
+// Read-only view of a whole file mapped into memory. The OS reads pages in as
+// they are touched and may drop them again under memory pressure, so a file
+// much larger than the working set can be read without copying it into RAM.
+class MappedFile {
+public:
+    MappedFile() = default;
+
+    explicit MappedFile(const std::string& path) {
+#ifdef _WIN32
+        file_ = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file_ == INVALID_HANDLE_VALUE) throw std::runtime_error("Cannot open file: " + path);
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file_, &size)) {
+            release();
+            throw std::runtime_error("Cannot read file size: " + path);
+        }
+        size_ = static_cast<std::size_t>(size.QuadPart);
+        if (size_ == 0) return;
+        mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        void* view = mapping_ ? MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0) : nullptr;
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) throw std::runtime_error("Cannot open file: " + path);
+        struct stat info;
+        if (::fstat(fd, &info) != 0) {
+            ::close(fd);
+            throw std::runtime_error("Cannot read file size: " + path);
+        }
+        size_ = static_cast<std::size_t>(info.st_size);
+        if (size_ == 0) {
+            ::close(fd);
+            return;
+        }
+        void* view = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        // The mapping keeps the file alive on its own.
+        ::close(fd);
+        if (view == MAP_FAILED) view = nullptr;
+#endif
+        if (!view) {
+            release();
+            throw std::runtime_error("Cannot map file: " + path);
+        }
+        data_ = static_cast<const std::uint8_t*>(view);
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept { swap(other); }
+    MappedFile& operator=(MappedFile&& other) noexcept {
+        if (this != &other) {
+            release();
+            swap(other);
+        }
+        return *this;
+    }
+
+    ~MappedFile() { release(); }
+
+    // Null for an empty file.
+    const std::uint8_t* data() const { return data_; }
+    std::size_t size() const { return size_; }
+
+    // Paging hints for a byte range; offset and length are widened to whole
+    // pages. willNeed starts reading the range in the background, and
+    // dontNeed lets the OS drop it from this mapping (the file's pages stay in
+    // its cache). Both are no-ops on Windows.
+    void willNeed(std::size_t offset, std::size_t length) const { advise(offset, length, true); }
+    void dontNeed(std::size_t offset, std::size_t length) const { advise(offset, length, false); }
+
+private:
+    void advise(std::size_t offset, std::size_t length, bool need) const {
+#ifdef _WIN32
+        (void)offset;
+        (void)length;
+        (void)need;
+#else
+        if (!data_ || offset >= size_) return;
+        static const std::size_t page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+        std::size_t begin = offset / page * page;
+        std::size_t end = std::min(size_, offset + length);
+        ::madvise(const_cast<std::uint8_t*>(data_) + begin, end - begin, need ? MADV_WILLNEED : MADV_DONTNEED);
+#endif
+    }
+
+    void swap(MappedFile& other) noexcept {
+        std::swap(data_, other.data_);
+        std::swap(size_, other.size_);
+#ifdef _WIN32
+        std::swap(file_, other.file_);
+        std::swap(mapping_, other.mapping_);
+#endif
+    }
+
+    void release() {
+#ifdef _WIN32
+        if (data_) UnmapViewOfFile(data_);
+        if (mapping_) CloseHandle(mapping_);
+        if (file_ != INVALID_HANDLE_VALUE) CloseHandle(file_);
+        mapping_ = nullptr;
+        file_ = INVALID_HANDLE_VALUE;
+#else
+        if (data_) ::munmap(const_cast<std::uint8_t*>(data_), size_);
+#endif
+        data_ = nullptr;
+        size_ = 0;
+    }
+
+    const std::uint8_t* data_ = nullptr;
+    std::size_t size_ = 0;
+#ifdef _WIN32
+    HANDLE file_ = INVALID_HANDLE_VALUE;
+    HANDLE mapping_ = nullptr;
+#endif
+};
+
+} // namespace Pathfinding
@@ -0,0 +1,440 @@
+#pragma once
+
+#include "Grid.hpp"
+#include "ThreadPool.hpp"
+#include "TiledGrid.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Pathfinding {
+
+// xoshiro256** seeded through SplitMix64. A few cycles per number against
+// mt19937_64's 2.5 KB of state, and the same stream on every platform, so a
+// seed names the same maze everywhere.
+class FastRandom {
+public:
+    explicit FastRandom(std::uint64_t seed) {
+        for (std::uint64_t& word : state_) {
+            seed += 0x9e3779b97f4a7c15ull;
+            std::uint64_t z = seed;
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+            word = z ^ (z >> 31);
+        }
+    }
+
+    std::uint64_t next() {
+        std::uint64_t result = rotl(state_[1] * 5, 7) * 9;
+        std::uint64_t t = state_[1] << 17;
+        state_[2] ^= state_[0];
+        state_[3] ^= state_[1];
+        state_[1] ^= state_[2];
+        state_[0] ^= state_[3];
+        state_[2] ^= t;
+        state_[3] = rotl(state_[3], 45);
+        return result;
+    }
+
+    // Uniform in [0, bound), by multiply-shift; the bias is under 2^-32.
+    std::uint32_t below(std::uint32_t bound) { return static_cast<std::uint32_t>(((next() >> 32) * bound) >> 32); }
+
+    bool chance(double probability) { return static_cast<double>(next() >> 11) * (1.0 / 9007199254740992.0) < probability; }
+
+private:
+    static std::uint64_t rotl(std::uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+    std::uint64_t state_[4];
+};
+
+enum class MazeAlgorithm { Backtracker, Kruskal, Prim, Eller, Wilson };
+
+class MazeGenerator {
+public:
+    // Makes each cell a wall independently with the given probability. The same
+    // seed always produces the same map, so benchmark corpora are reproducible.
+    static void generateRandomWalls(Grid& grid, double probability, std::uint64_t seed) {
+        std::mt19937_64 rng(seed);
+        std::bernoulli_distribution dist(probability);
+
+        std::vector<std::uint64_t> words;
+        for (int y = 0; y < grid.height(); ++y) {
+            words.assign(grid.wordsPerRow(), 0);
+            for (int x = 0; x < grid.width(); ++x) {
+                if (dist(rng)) words[x >> 6] |= std::uint64_t(1) << (x & 63);
+            }
+            grid.setRow(y, words.data());
+        }
+    }
+
+    // Streams a map of random walls straight to a tiled map file, for maps
+    // too large to build in memory. Each row draws from its own stream, so
+    // the map depends only on the seed. Throws if the file cannot be written.
+    static void writeTiledRandomWalls(const std::string& path, int width, int height, double probability, std::uint64_t seed) {
+        // 16-bit thresholds, four cells to a random number.
+        std::uint64_t threshold = static_cast<std::uint64_t>(std::max(0.0, std::min(probability, 1.0)) * 65536.0);
+        TiledGrid::write(path, width, height, [&](int y, std::uint64_t* words) {
+            FastRandom random(mix(seed, static_cast<std::uint64_t>(y)));
+            std::uint64_t bits = 0;
+            for (int x = 0; x < width; ++x) {
+                if ((x & 3) == 0) bits = random.next();
+                if ((bits & 0xffff) < threshold) words[x >> 5] |= std::uint64_t(1) << ((x & 31) * 2);  // code 1, a wall
+                bits >>= 16;
+            }
+            });
+    }
+
+    // Carves a perfect maze, one path between any two rooms, then braids it.
+    // Rooms sit at odd coordinates and every other cell starts as a wall; an
+    // even width or height leaves the last column or row solid. braid is the
+    // fraction of dead ends knocked through to a neighbouring room, which adds
+    // loops. Costs are left as they are.
+    //
+    // Every algorithm but Eller's carves 128x128-room tiles independently, on
+    // the pool when there is one, then links the tiles into one tree through a
+    // random passage per link. The output depends only on the seed.
+    static void generateMaze(Grid& grid, MazeAlgorithm algorithm, std::uint64_t seed, double braid = 0.0,
+        ThreadPool* pool = nullptr) {
+        Layout maze(grid);
+        if (maze.roomsX > 0 && maze.roomsY > 0) {
+            if (algorithm == MazeAlgorithm::Eller) eller(maze, seed);
+            else carveTiles(maze, algorithm, seed, pool);
+            if (braid > 0) braidDeadEnds(maze, braid, seed, pool);
+        }
+        for (int y = 0; y < grid.height(); ++y) grid.setRow(y, maze.row(y));
+    }
+
+    // Fills the cell costs with smooth terrain from 1 to maxCost: random
+    // values on a lattice every `scale` cells, blended bilinearly in between,
+    // so costs come in patches rather than per-cell noise. Walls are left as
+    // they are.
+    static void generateTerrain(Grid& grid, int maxCost, std::uint64_t seed, int scale = 8) {
+        std::mt19937_64 rng(seed);
+        std::uniform_real_distribution<double> dist(0.0, 1.0);
+        int latticeWidth = grid.width() / scale + 2;
+        int latticeHeight = grid.height() / scale + 2;
+        std::vector<double> lattice(static_cast<std::size_t>(latticeWidth) * latticeHeight);
+        for (double& value : lattice) value = dist(rng);
+
+        for (int y = 0; y < grid.height(); ++y) {
+            int ly = y / scale;
+            double fy = double(y % scale) / scale;
+            for (int x = 0; x < grid.width(); ++x) {
+                int lx = x / scale;
+                double fx = double(x % scale) / scale;
+                auto at = [&](int cx, int cy) { return lattice[static_cast<std::size_t>(cy) * latticeWidth + cx]; };
+                double top = at(lx, ly) * (1 - fx) + at(lx + 1, ly) * fx;
+                double bottom = at(lx, ly + 1) * (1 - fx) + at(lx + 1, ly + 1) * fx;
+                double value = top * (1 - fy) + bottom * fy;
+                grid.setCost(x, y, 1 + static_cast<int>(value * maxCost));
+            }
+        }
+    }
+
+private:
+    // A multiple of 32 rooms (64 cells), so a tile's rooms, the passages
+    // between them and its left and top walls fill whole bitmap words that
+    // no other tile writes.
+    static constexpr int kTileRooms = 128;
+
+    // Directions in FourConnected order: left, up, down, right.
+    static constexpr int kDx[4] = { -1, 0, 0, 1 };
+    static constexpr int kDy[4] = { 0, -1, 1, 0 };
+
+    // Wall bitmap under construction, laid out like Grid's. Room (rx, ry) is
+    // cell (2rx + 1, 2ry + 1).
+    struct Layout {
+        int width, height, wordsPerRow, roomsX, roomsY;
+        std::vector<std::uint64_t> walls;
+
+        explicit Layout(const Grid& grid)
+            : width(grid.width()), height(grid.height()), wordsPerRow(grid.wordsPerRow()),
+            roomsX(std::max(0, (grid.width() - 1) / 2)), roomsY(std::max(0, (grid.height() - 1) / 2)),
+            walls(static_cast<std::size_t>(wordsPerRow) * height, ~std::uint64_t(0)) {
+            // Bits past the width stay clear, as in Grid.
+            if (width % 64 != 0) {
+                for (int y = 0; y < height; ++y) walls[static_cast<std::size_t>(y) * wordsPerRow + wordsPerRow - 1] = (std::uint64_t(1) << (width % 64)) - 1;
+            }
+        }
+
+        const std::uint64_t* row(int y) const { return walls.data() + static_cast<std::size_t>(y) * wordsPerRow; }
+
+        std::uint64_t& word(int x, int y) { return walls[static_cast<std::size_t>(y) * wordsPerRow + (x >> 6)]; }
+        void open(int x, int y) { word(x, y) &= ~(std::uint64_t(1) << (x & 63)); }
+        bool isOpen(int x, int y) { return !((word(x, y) >> (x & 63)) & 1); }
+
+        void openRoom(int rx, int ry) { open(2 * rx + 1, 2 * ry + 1); }
+        // Opens the passage from room (rx, ry) in direction d.
+        void join(int rx, int ry, int d) { open(2 * rx + 1 + kDx[d], 2 * ry + 1 + kDy[d]); }
+        bool joined(int rx, int ry, int d) { return isOpen(2 * rx + 1 + kDx[d], 2 * ry + 1 + kDy[d]); }
+    };
+
+    // The rooms of one tile, numbered locally as ly * kTileRooms + lx so the
+    // split back into coordinates is a shift and a mask. Edge tiles are
+    // narrower; indices past w or h in them are not rooms.
+    struct Tile {
+        int x0, y0, w, h;
+
+        static constexpr int kSlots = kTileRooms * kTileRooms;
+        static int localX(int i) { return i & (kTileRooms - 1); }
+        static int localY(int i) { return i / kTileRooms; }
+
+        int rooms() const { return w * h; }
+        // The i-th room in row-major order, as a local index.
+        int room(int n) const { return n / w * kTileRooms + n % w; }
+        // Local index of the neighbour of room i in direction d, or -1 off the tile.
+        int neighbour(int i, int d) const {
+            int lx = localX(i) + kDx[d], ly = localY(i) + kDy[d];
+            return lx < 0 || lx >= w || ly < 0 || ly >= h ? -1 : ly * kTileRooms + lx;
+        }
+        void join(Layout& maze, int i, int d) const { maze.join(x0 + localX(i), y0 + localY(i), d); }
+    };
+
+    template <class Fn>
+    static void forEach(ThreadPool* pool, std::size_t count, Fn&& fn) {
+        if (pool) pool->parallelFor(count, fn);
+        else for (std::size_t i = 0; i < count; ++i) fn(i, 0);
+    }
+
+    static std::uint64_t mix(std::uint64_t seed, std::uint64_t stream) { return seed ^ (stream + 1) * 0xd1b54a32d192ed03ull; }
+
+    static int findRoot(std::vector<int>& parent, int i) {
+        while (parent[i] != i) i = parent[i] = parent[parent[i]];
+        return i;
+    }
+
+    static void carveTiles(Layout& maze, MazeAlgorithm algorithm, std::uint64_t seed, ThreadPool* pool) {
+        int tilesX = (maze.roomsX + kTileRooms - 1) / kTileRooms;
+        int tilesY = (maze.roomsY + kTileRooms - 1) / kTileRooms;
+        auto tileAt = [&](int tx, int ty) {
+            int x0 = tx * kTileRooms, y0 = ty * kTileRooms;
+            return Tile{ x0, y0, std::min(kTileRooms, maze.roomsX - x0), std::min(kTileRooms, maze.roomsY - y0) };
+        };
+
+        forEach(pool, static_cast<std::size_t>(tilesX) * tilesY, [&](std::size_t index, unsigned) {
+            Tile tile = tileAt(static_cast<int>(index % tilesX), static_cast<int>(index / tilesX));
+            for (int y = 0; y < tile.h; ++y) {
+                for (int x = 0; x < tile.w; ++x) maze.openRoom(tile.x0 + x, tile.y0 + y);
+            }
+            FastRandom random(mix(seed, index));
+            switch (algorithm) {
+            case MazeAlgorithm::Backtracker: backtracker(maze, tile, random); break;
+            case MazeAlgorithm::Kruskal: kruskal(maze, tile, random); break;
+            case MazeAlgorithm::Prim: prim(maze, tile, random); break;
+            default: wilson(maze, tile, random); break;
+            }
+            });
+
+        // Each tile is now one tree. Kruskal over the tile links, in random
+        // order, joins them through one random passage per link taken.
+        std::vector<std::pair<int, int>> links;  // tile, direction (right or down)
+        for (int t = 0; t < tilesX * tilesY; ++t) {
+            if (t % tilesX + 1 < tilesX) links.push_back({ t, 3 });
+            if (t / tilesX + 1 < tilesY) links.push_back({ t, 2 });
+        }
+        FastRandom random(mix(seed, ~std::uint64_t(0)));
+        shuffle(links, random);
+        std::vector<int> parent(tilesX * tilesY);
+        for (int t = 0; t < tilesX * tilesY; ++t) parent[t] = t;
+        for (auto [t, d] : links) {
+            int other = d == 3 ? t + 1 : t + tilesX;
+            int a = findRoot(parent, t), b = findRoot(parent, other);
+            if (a == b) continue;
+            parent[a] = b;
+            Tile tile = tileAt(t % tilesX, t / tilesX);
+            if (d == 3) maze.join(tile.x0 + tile.w - 1, tile.y0 + static_cast<int>(random.below(tile.h)), 3);
+            else maze.join(tile.x0 + static_cast<int>(random.below(tile.w)), tile.y0 + tile.h - 1, 2);
+        }
+    }
+
+    template <class T>
+    static void shuffle(std::vector<T>& items, FastRandom& random) {
+        for (std::size_t i = items.size(); i > 1; --i) std::swap(items[i - 1], items[random.below(static_cast<std::uint32_t>(i))]);
+    }
+
+    // Depth-first search that carves into a random unvisited neighbour and
+    // backs up at dead ends: long winding corridors, few branches.
+    static void backtracker(Layout& maze, const Tile& tile, FastRandom& random) {
+        std::vector<std::uint8_t> seen(Tile::kSlots, 0);
+        std::vector<int> stack;
+        int first = tile.room(static_cast<int>(random.below(tile.rooms())));
+        seen[first] = 1;
+        stack.push_back(first);
+        while (!stack.empty()) {
+            int current = stack.back();
+            int options[4], count = 0;
+            for (int d = 0; d < 4; ++d) {
+                int next = tile.neighbour(current, d);
+                if (next >= 0 && !seen[next]) options[count++] = d;
+            }
+            if (count == 0) {
+                stack.pop_back();
+                continue;
+            }
+            int d = options[random.below(count)];
+            int next = tile.neighbour(current, d);
+            tile.join(maze, current, d);
+            seen[next] = 1;
+            stack.push_back(next);
+        }
+    }
+
+    // Opens every wall in random order unless its rooms are already
+    // connected: many short dead ends.
+    static void kruskal(Layout& maze, const Tile& tile, FastRandom& random) {
+        std::vector<int> walls;  // room * 4 + direction, right and down only
+        for (int n = 0; n < tile.rooms(); ++n) {
+            int i = tile.room(n);
+            if (tile.neighbour(i, 3) >= 0) walls.push_back(i * 4 + 3);
+            if (tile.neighbour(i, 2) >= 0) walls.push_back(i * 4 + 2);
+        }
+        shuffle(walls, random);
+        std::vector<int> parent(Tile::kSlots);
+        for (int i = 0; i < Tile::kSlots; ++i) parent[i] = i;
+        for (int wall : walls) {
+            int i = wall / 4, d = wall % 4;
+            int a = findRoot(parent, i), b = findRoot(parent, tile.neighbour(i, d));
+            if (a == b) continue;
+            parent[a] = b;
+            tile.join(maze, i, d);
+        }
+    }
+
+    // Grows one tree by attaching a random frontier room to a random room
+    // already in it: short, branchy passages radiating from the start.
+    static void prim(Layout& maze, const Tile& tile, FastRandom& random) {
+        enum : std::uint8_t { Out, Frontier, In };
+        std::vector<std::uint8_t> state(Tile::kSlots, Out);
+        std::vector<int> frontier;
+        auto add = [&](int room) {
+            state[room] = In;
+            for (int d = 0; d < 4; ++d) {
+                int next = tile.neighbour(room, d);
+                if (next >= 0 && state[next] == Out) {
+                    state[next] = Frontier;
+                    frontier.push_back(next);
+                }
+            }
+        };
+
+        add(tile.room(static_cast<int>(random.below(tile.rooms()))));
+        while (!frontier.empty()) {
+            std::size_t pick = random.below(static_cast<std::uint32_t>(frontier.size()));
+            int room = frontier[pick];
+            frontier[pick] = frontier.back();
+            frontier.pop_back();
+
+            int options[4], count = 0;
+            for (int d = 0; d < 4; ++d) {
+                int next = tile.neighbour(room, d);
+                if (next >= 0 && state[next] == In) options[count++] = d;
+            }
+            tile.join(maze, room, options[random.below(count)]);
+            add(room);
+        }
+    }
+
+    // Loop-erased random walks from each room outside the tree until they hit
+    // it: a uniformly random spanning tree of the tile, with no bias in
+    // corridor length or direction.
+    static void wilson(Layout& maze, const Tile& tile, FastRandom& random) {
+        std::vector<std::uint8_t> inTree(Tile::kSlots, 0);
+        std::vector<std::uint8_t> exits(Tile::kSlots, 0); // last direction the walk left each room by
+        inTree[tile.room(static_cast<int>(random.below(tile.rooms())))] = 1;
+        for (int n = 0; n < tile.rooms(); ++n) {
+            int start = tile.room(n);
+            if (inTree[start]) continue;
+            // Overwriting a room's exit on revisits erases the loop.
+            for (int room = start; !inTree[room];) {
+                int d;
+                do d = static_cast<int>(random.below(4));
+                while (tile.neighbour(room, d) < 0);
+                exits[room] = static_cast<std::uint8_t>(d);
+                room = tile.neighbour(room, d);
+            }
+            for (int room = start; !inTree[room]; room = tile.neighbour(room, exits[room])) {
+                inTree[room] = 1;
+                tile.join(maze, room, exits[room]);
+            }
+        }
+    }
+
+    // Eller's algorithm carves one row of rooms at a time, keeping only
+    // which rooms of the current row are already connected, so its working
+    // memory is a few ints per column however tall the maze. Rows depend on
+    // the row above, so it always runs on the calling thread.
+    static void eller(Layout& maze, std::uint64_t seed) {
+        FastRandom random(seed);
+        int w = maze.roomsX;
+        // label[x] names the set room x joined from the row above, or -1.
+        std::vector<int> label(w, -1), nextLabel(w), parent(w), firstWithLabel(w), lastInSet(w);
+        std::vector<std::uint8_t> goesDown(w);
+
+        for (int y = 0; y < maze.roomsY; ++y) {
+            bool lastRow = y + 1 == maze.roomsY;
+            std::fill(firstWithLabel.begin(), firstWithLabel.end(), -1);
+            for (int x = 0; x < w; ++x) {
+                maze.openRoom(x, y);
+                parent[x] = x;
+                if (label[x] < 0) continue;
+                if (firstWithLabel[label[x]] < 0) firstWithLabel[label[x]] = x;
+                else parent[x] = firstWithLabel[label[x]];
+            }
+
+            // Join neighbours in different sets at random; the last row joins
+            // them all, so the maze ends up connected.
+            for (int x = 0; x + 1 < w; ++x) {
+                int a = findRoot(parent, x), b = findRoot(parent, x + 1);
+                if (a == b || !(lastRow || random.chance(0.5))) continue;
+                parent[b] = a;
+                maze.join(x, y, 3);
+            }
+            if (lastRow) break;
+
+            // Every set carries on down through at least one room.
+            for (int x = 0; x < w; ++x) {
+                lastInSet[findRoot(parent, x)] = x;
+                goesDown[x] = 0;
+            }
+            for (int x = 0; x < w; ++x) {
+                int root = findRoot(parent, x);
+                bool down = random.chance(0.5) || (lastInSet[root] == x && !goesDown[root]);
+                if (down) {
+                    goesDown[root] = 1;
+                    maze.join(x, y, 2);
+                }
+                nextLabel[x] = down ? root : -1;
+            }
+            std::swap(label, nextLabel);
+        }
+    }
+
+    // Opens a random closed wall of each dead end with probability braid.
+    // Rows of rooms touching the same wall row never run together: even rows
+    // go first, then odd ones, each row on its own stream.
+    static void braidDeadEnds(Layout& maze, double braid, std::uint64_t seed, ThreadPool* pool) {
+        for (int parity = 0; parity < 2; ++parity) {
+            forEach(pool, static_cast<std::size_t>(maze.roomsY + 1 - parity) / 2, [&](std::size_t i, unsigned) {
+                int ry = static_cast<int>(i) * 2 + parity;
+                FastRandom random(mix(seed ^ 0xb4a1d5ull, static_cast<std::uint64_t>(ry)));
+                for (int rx = 0; rx < maze.roomsX; ++rx) {
+                    int open = 0, closed[4], count = 0;
+                    for (int d = 0; d < 4; ++d) {
+                        int nx = rx + kDx[d], ny = ry + kDy[d];
+                        if (nx < 0 || nx >= maze.roomsX || ny < 0 || ny >= maze.roomsY) continue;
+                        if (maze.joined(rx, ry, d)) ++open;
+                        else closed[count++] = d;
+                    }
+                    if (open == 1 && count > 0 && random.chance(braid)) maze.join(rx, ry, closed[random.below(count)]);
+                }
+                });
+        }
+    }
+};
+
+} // namespace Pathfinding
@@ -0,0 +1,245 @@
+#pragma once
+
+#include "AnytimeSearch.hpp"
+#include "BidirectionalSearch.hpp"
+#include "ComponentIndex.hpp"
+#include "FlowField.hpp"
+#include "Grid.hpp"
+#include "HierarchicalSearch.hpp"
+#include "IncrementalPlanner.hpp"
+#include "JumpPointSearch.hpp"
+#include "LandmarkTable.hpp"
+#include "SearchArena.hpp"
+#include "SearchKernel.hpp"
+#include "SearchObserver.hpp"
+#include "SearchResult.hpp"
+#include "WavefrontBFS.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+namespace Pathfinding {
+
+enum class Algorithm { BFS, DFS, AStar, Dijkstra, Greedy, JPS, JPSPlus, BidirectionalBFS, BidirectionalAStar, Wavefront, DStarLite, HPAStar, ALT, FlowField };
+
+// Moves allowed between cells. Dijkstra, A* and greedy search honour Eight
+// (diagonals without corner cutting, A* with the octile heuristic). ALT's
+// landmark distances are 4-connected, so with Eight it runs as plain A*. The
+// other searches always move 4-connected.
+enum class Connectivity { Four, Eight };
+
+// Headless search routines. Progress is reported through the observer, which
+// defaults to NullObserver so benchmark and server callers pay nothing for it.
+class Pathfinder {
+public:
+    static SearchResult findPath(Algorithm algo, const Grid& grid, Point start, Point end, Connectivity moves = Connectivity::Four) {
+        NullObserver observer;
+        return findPath(algo, grid, start, end, observer, moves);
+    }
+
+    // Uses a scratch arena owned by the calling thread, so repeated queries on
+    // one thread stop allocating after the first.
+    template <class Observer>
+    static SearchResult findPath(Algorithm algo, const Grid& grid, Point start, Point end, Observer& observer,
+        Connectivity moves = Connectivity::Four) {
+        static thread_local SearchArena arena;
+        return findPath(algo, grid, start, end, observer, arena, moves);
+    }
+
+    // Runs the search in caller-owned scratch memory. The bidirectional and
+    // wavefront searches keep state of their own and ignore the arena. D* Lite
+    // plans from scratch here; keep an IncrementalPlanner to replan after edits.
+    // FlowField follows the shared field for the goal, so every query to the
+    // same goal after the first costs only its path length.
+    template <class Observer>
+    static SearchResult findPath(Algorithm algo, const Grid& grid, Point start, Point end, Observer& observer, SearchArena& arena,
+        Connectivity moves = Connectivity::Four) {
+        observer.onPhase(SearchPhase::Setup);
+        SearchResult result = dispatch(algo, grid, start, end, observer, arena, *ComponentIndex::shared(grid), moves);
+        observer.onPhase(SearchPhase::Done);
+        return result;
+    }
+
+    // As above, against a component index the caller already holds for the
+    // grid's current contents, so a batch of queries looks it up only once.
+    template <class Observer>
+    static SearchResult findPath(Algorithm algo, const Grid& grid, Point start, Point end, Observer& observer, SearchArena& arena,
+        const ComponentIndex& components, Connectivity moves = Connectivity::Four) {
+        observer.onPhase(SearchPhase::Setup);
+        SearchResult result = dispatch(algo, grid, start, end, observer, arena, components, moves);
+        observer.onPhase(SearchPhase::Done);
+        return result;
+    }
+
+private:
+    template <class Observer>
+    static SearchResult dispatch(Algorithm algo, const Grid& grid, Point start, Point end, Observer& observer, SearchArena& arena,
+        const ComponentIndex& components, Connectivity moves) {
+        if (!grid.inBounds(start.x, start.y) || !grid.inBounds(end.x, end.y)) return {};
+
+        int s = grid.index(start.x, start.y);
+        int e = grid.index(end.x, end.y);
+        // Endpoints in different components have no path; answer before any
+        // search touches its scratch memory. Diagonal moves never join
+        // components, so this holds for both connectivities.
+        if (!components.connected(s, e)) return {};
+        bool diagonal = moves == Connectivity::Eight;
+        switch (algo) {
+        case Algorithm::BFS: return BFS(grid, s, e, observer, arena);
+        case Algorithm::DFS: return DFS(grid, s, e, observer, arena);
+        case Algorithm::AStar:
+            return diagonal ? SearchKernel<EightConnected<>, OctileHeuristic, BucketOpenList>::run(grid, s, e, observer, arena)
+                : SearchKernel<FourConnected, ManhattanHeuristic, BucketOpenList>::run(grid, s, e, observer, arena);
+        case Algorithm::Dijkstra:
+            return diagonal ? SearchKernel<EightConnected<>, ZeroHeuristic, BucketOpenList>::run(grid, s, e, observer, arena)
+                : SearchKernel<FourConnected, ZeroHeuristic, BucketOpenList>::run(grid, s, e, observer, arena);
+        case Algorithm::Greedy:
+            return diagonal ? greedy<EightConnected<>, OctileHeuristic>(grid, s, e, observer, arena)
+                : greedy<FourConnected, ManhattanHeuristic>(grid, s, e, observer, arena);
+        case Algorithm::JPS: return JumpPointSearch::search(grid, s, e, nullptr, observer, arena);
+        case Algorithm::JPSPlus: return JumpPointSearch::search(grid, s, e, JumpTable::shared(grid).get(), observer, arena);
+        case Algorithm::BidirectionalBFS: return BidirectionalSearch::bfs(grid, s, e, observer);
+        case Algorithm::BidirectionalAStar: return BidirectionalSearch::aStar(grid, s, e, observer);
+        case Algorithm::Wavefront: return WavefrontBFS::search(grid, s, e, observer);
+        case Algorithm::DStarLite: return IncrementalPlanner().plan(grid, s, e, observer);
+        case Algorithm::HPAStar: return HierarchicalMap::shared(grid)->search(grid, s, e, observer, arena);
+        case Algorithm::FlowField: return FlowField::shared(grid, e)->path(grid, s, observer);
+        case Algorithm::ALT:
+            if (diagonal) return SearchKernel<EightConnected<>, OctileHeuristic, BucketOpenList>::run(grid, s, e, observer, arena);
+            else {
+                std::shared_ptr<const LandmarkTable> table = LandmarkTable::shared(grid);
+                LandmarkHeuristic heuristic(*table, grid, e);
+                // A walled start has no landmark distances, so keys can jump past
+                // the bucket ring on the first step; the heap takes any keys.
+                if (grid.isWall(s)) return SearchKernel<FourConnected, LandmarkHeuristic, HeapOpenList>::run(grid, s, e, observer, arena, heuristic);
+                return SearchKernel<FourConnected, LandmarkHeuristic, BucketOpenList>::run(grid, s, e, observer, arena, heuristic);
+            }
+        }
+        return {};
+    }
+
+    // Calls fn(neighbourIndex) for each open 4-neighbour of index, in the
+    // left, up, down, right order the routines have always used.
+    template <class Fn>
+    static void forEachNeighbour(const Grid& grid, int index, Fn&& fn) {
+        Neighbours<FourConnected>::forEach(grid, index, [&](int next, int) { fn(next); });
+    }
+
+    template <class Observer>
+    static SearchResult BFS(const Grid& grid, int start, int end, Observer& observer, SearchArena& arena) {
+        arena.begin(grid.cellCount());
+        std::vector<int>& q = arena.buffer;
+
+        q.push_back(start);
+        arena.reach(start, -1);
+        observer.onPhase(SearchPhase::Search);
+
+        for (std::size_t head = 0; head < q.size(); ++head) {
+            int current = q[head];
+            observer.onPop(current);
+
+            if (current == end) {
+                observer.onPhase(SearchPhase::Reconstruct);
+                return reconstructPath(arena, start, end, observer);
+            }
+            observer.onExpand(current);
+
+            forEachNeighbour(grid, current, [&](int next) {
+                observer.onGenerate(next);
+                if (arena.reached(next)) return;
+                arena.reach(next, current);
+                q.push_back(next);
+                observer.onVisit(next);
+                if constexpr (Observer::enabled) observer.onOpenSize(q.size() - head - 1);
+                });
+        }
+        return {};
+    }
+
+    template <class Observer>
+    static SearchResult DFS(const Grid& grid, int start, int end, Observer& observer, SearchArena& arena) {
+        arena.begin(grid.cellCount());
+        std::vector<int>& s = arena.buffer;
+
+        s.push_back(start);
+        arena.reach(start, -1);
+        observer.onPhase(SearchPhase::Search);
+
+        while (!s.empty()) {
+            int current = s.back();
+            s.pop_back();
+            observer.onPop(current);
+
+            if (current == end) {
+                observer.onPhase(SearchPhase::Reconstruct);
+                return reconstructPath(arena, start, end, observer);
+            }
+            observer.onExpand(current);
+
+            forEachNeighbour(grid, current, [&](int next) {
+                observer.onGenerate(next);
+                if (arena.reached(next)) return;
+                arena.reach(next, current);
+                s.push_back(next);
+                observer.onVisit(next);
+                if constexpr (Observer::enabled) observer.onOpenSize(s.size());
+                });
+        }
+        return {};
+    }
+
+    // Dijkstra and A* run on SearchKernel; greedy search shares its
+    // neighbourhoods and heuristics but orders the open list by h alone.
+    template <class Moves, class Heuristic, class Observer>
+    static SearchResult greedy(const Grid& grid, int start, int end, Observer& observer, SearchArena& arena) {
+        arena.begin(grid.cellCount());
+        OpenList& pq = arena.open;
+        Heuristic heuristic;
+        auto estimate = [&](int cell) { return heuristic.template between<Moves>(grid, cell, end); };
+
+        pq.push({ estimate(start), 0, start });
+        arena.reach(start, -1);
+        observer.onPhase(SearchPhase::Search);
+
+        while (!pq.empty()) {
+            int current = pq.top().index;
+            pq.pop();
+            observer.onPop(current);
+
+            if (current == end) {
+                observer.onPhase(SearchPhase::Reconstruct);
+                return reconstructPath(arena, start, end, observer);
+            }
+            observer.onExpand(current);
+
+            Neighbours<Moves>::forEach(grid, current, [&](int next, int) {
+                observer.onGenerate(next);
+                if (arena.reached(next)) return;
+                arena.reach(next, current);
+                pq.push({ estimate(next), 0, next });
+                observer.onVisit(next);
+                if constexpr (Observer::enabled) observer.onOpenSize(pq.size());
+                });
+        }
+        return {};
+    }
+
+    template <class Observer>
+    static SearchResult reconstructPath(const SearchArena& arena, int start, int end, Observer& observer) {
+        SearchResult result;
+        result.found = true;
+
+        for (int current = end; current != start; current = arena.parent(current)) {
+            result.path.push_back(current);
+            observer.onPath(current);
+        }
+        result.path.push_back(start);
+        std::reverse(result.path.begin(), result.path.end());
+        return result;
+    }
+};
+
+} // namespace Pathfinding
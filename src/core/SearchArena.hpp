@@ -0,0 +1,154 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <vector>
+
+namespace Pathfinding {
+
+// Binary min-heap of search entries ordered by (key, tie, index). Its storage
+// is kept between searches, so a warmed-up list never allocates.
+class OpenList {
+public:
+    struct Entry {
+        int key;   // f, g or h, depending on the search
+        int tie;   // secondary key; searches that prefer deeper nodes store -g
+        int index;
+
+        bool operator>(const Entry& other) const {
+            if (key != other.key) return key > other.key;
+            if (tie != other.tie) return tie > other.tie;
+            return index > other.index;
+        }
+    };
+
+    bool empty() const { return heap_.empty(); }
+    std::size_t size() const { return heap_.size(); }
+    const Entry& top() const { return heap_.front(); }
+
+    void push(const Entry& entry) {
+        heap_.push_back(entry);
+        std::push_heap(heap_.begin(), heap_.end(), std::greater<Entry>());
+    }
+
+    void pop() {
+        std::pop_heap(heap_.begin(), heap_.end(), std::greater<Entry>());
+        heap_.pop_back();
+    }
+
+    void clear() { heap_.clear(); }
+
+private:
+    std::vector<Entry> heap_;
+};
+
+// Monotone priority queue for small integer keys (Dial's algorithm). Every
+// key pushed must lie in [top, top + span), where top is the key last popped.
+// That holds for Dijkstra when span exceeds the largest step cost, and for A*
+// with a consistent heuristic when span exceeds it by two. Keys map onto a
+// ring of buckets, so push and pop are O(1) amortised. Within a bucket the
+// newest entry pops first, which makes A* prefer the deeper of equal-f cells.
+class BucketQueue {
+public:
+    struct Entry {
+        int index;
+        int g;
+    };
+
+    // Empties the queue; the first key pushed must be at least top.
+    void reset(int span, int top) {
+        // Leftovers from an early exit sit within one span of the old top.
+        for (std::size_t i = 0; size_ > 0; ++i) {
+            std::vector<Entry>& bucket = buckets_[(top_ + i) % span_];
+            size_ -= bucket.size();
+            bucket.clear();
+        }
+        if (buckets_.size() < static_cast<std::size_t>(span)) buckets_.resize(span);
+        span_ = span;
+        top_ = top;
+        size_ = 0;
+    }
+
+    bool empty() const { return size_ == 0; }
+    std::size_t size() const { return size_; }
+
+    void push(int key, const Entry& entry) {
+        buckets_[key % span_].push_back(entry);
+        ++size_;
+    }
+
+    // Removes an entry with the smallest key and stores that key in key.
+    Entry pop(int& key) {
+        while (buckets_[top_ % span_].empty()) ++top_;
+        std::vector<Entry>& bucket = buckets_[top_ % span_];
+        Entry entry = bucket.back();
+        bucket.pop_back();
+        --size_;
+        key = top_;
+        return entry;
+    }
+
+private:
+    std::vector<std::vector<Entry>> buckets_;
+    int span_ = 1;
+    int top_ = 0;
+    std::size_t size_ = 0;
+};
+
+// Scratch memory for one search at a time: cost and parent per cell, the open
+// list, a bucket queue and a FIFO/LIFO buffer. Cells are tagged with the
+// generation of the search that last wrote them, so a new search normally
+// starts without clearing anything. Keep one arena per thread and reuse it across queries.
+class SearchArena {
+public:
+    static constexpr int kUnreached = std::numeric_limits<int>::max();
+
+    // Starts a new search over a grid of cellCount cells.
+    void begin(int cellCount) {
+        if (stamp_.size() < static_cast<std::size_t>(cellCount)) {
+            stamp_.assign(cellCount, 0);
+            cost_.resize(cellCount);
+            parent_.resize(cellCount);
+        }
+        if (++generation_ == 0) {
+            // The stamps wrapped around: forget every old tag once.
+            std::fill(stamp_.begin(), stamp_.end(), 0);
+            generation_ = 1;
+        }
+        open.clear();
+        buffer.clear();
+    }
+
+    bool reached(int index) const { return stamp_[index] == generation_; }
+    int cost(int index) const { return reached(index) ? cost_[index] : kUnreached; }
+    int parent(int index) const { return reached(index) ? parent_[index] : -1; }
+
+    void reach(int index, int cost, int parent) {
+        stamp_[index] = generation_;
+        cost_[index] = cost;
+        parent_[index] = parent;
+    }
+
+    // reach() for searches that never read costs back.
+    void reach(int index, int parent) {
+        stamp_[index] = generation_;
+        parent_[index] = parent;
+    }
+
+    OpenList open;
+    BucketQueue buckets;
+    std::vector<int> buffer;
+
+private:
+    // One byte per stamp keeps the reached test as cache-dense as a plain
+    // visited array; the price is a full clear every 255 searches.
+    std::uint8_t generation_ = 0;
+    std::vector<std::uint8_t> stamp_;
+    std::vector<int> cost_;
+    std::vector<int> parent_;
+};
+
+} // namespace Pathfinding
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "SearchObserver.hpp"
+#include "SpscQueue.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+
+namespace Pathfinding {
+
+struct SearchEvent {
+    enum class Type : std::uint8_t { Visit, Path };
+
+    Type type = Type::Visit;
+    int index = -1;
+};
+
+// Forwards observer callbacks into a ring buffer drained by another thread.
+// When the ring is full the producer yields until space frees up, unless the
+// consumer has cancelled the run, in which case further events are dropped so
+// the search can finish without anyone listening.
+struct QueueObserver : NullObserver {
+    static constexpr bool enabled = true;
+
+    SpscQueue<SearchEvent>& queue;
+    const std::atomic<bool>& cancelled;
+
+    QueueObserver(SpscQueue<SearchEvent>& queue, const std::atomic<bool>& cancelled)
+        : queue(queue), cancelled(cancelled) {}
+
+    void onVisit(int index) { push({ SearchEvent::Type::Visit, index }); }
+    void onPath(int index) { push({ SearchEvent::Type::Path, index }); }
+
+    void push(const SearchEvent& event) {
+        while (!queue.tryPush(event)) {
+            if (cancelled.load(std::memory_order_relaxed)) return;
+            std::this_thread::yield();
+        }
+    }
+};
+
+} // namespace Pathfinding
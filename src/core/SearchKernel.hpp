@@ -0,0 +1,252 @@
+#pragma once
+
+#include "Grid.hpp"
+#include "SearchArena.hpp"
+#include "SearchObserver.hpp"
+#include "SearchResult.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <type_traits>
+#include <utility>
+
+namespace Pathfinding {
+
+// Policies for SearchKernel. Each one is a plain type with constexpr tables,
+// so every combination compiles to its own loop with the direction checks
+// unrolled and the unused branches gone.
+
+// Neighbourhoods list their directions and the cost units of a straight and
+// a diagonal step; the kernel multiplies the unit by the cost of the cell it
+// enters. Directions come in the left, up, down, right order the searches
+// have always used, followed by the diagonals.
+struct FourConnected {
+    static constexpr int kDirections = 4;
+    static constexpr int kDx[kDirections] = { -1, 0, 0, 1 };
+    static constexpr int kDy[kDirections] = { 0, -1, 1, 0 };
+    static constexpr int kStraight = 1;
+    static constexpr int kDiagonal = 2; // a diagonal offset takes two straight steps
+    static constexpr int kLongestStep = kStraight;
+};
+
+// Diagonal steps cost 99/70, just above sqrt(2), so the octile and Euclidean
+// heuristics stay consistent with whole-number costs. Without corner cutting
+// a diagonal needs both orthogonal cells open; with it, one is enough. Either
+// way a diagonal never squeezes between two walls, so 8-connected searches
+// reach exactly the 4-connected components.
+template <bool CutCorners = false>
+struct EightConnected {
+    static constexpr int kDirections = 8;
+    static constexpr int kDx[kDirections] = { -1, 0, 0, 1, -1, 1, -1, 1 };
+    static constexpr int kDy[kDirections] = { 0, -1, 1, 0, -1, -1, 1, 1 };
+    static constexpr int kStraight = 70;
+    static constexpr int kDiagonal = 99;
+    static constexpr int kLongestStep = kDiagonal;
+    static constexpr bool kCutCorners = CutCorners;
+};
+
+// Heuristics estimate the cost to the goal in the neighbourhood's units.
+// between() gives the estimate from a cell, and maxRise() bounds how much it
+// may grow over one step, which sizes the bucket queue. The kernel takes a
+// heuristic object, so a heuristic may carry per-map state (LandmarkHeuristic).
+//
+// The geometric heuristics below only look at the absolute offsets dx and dy.
+// All of them are consistent when paired as the kernel allows: every cell
+// costs at least 1, so a step costs at least its unit.
+template <class Derived>
+struct OffsetHeuristic {
+    template <class Moves>
+    int between(const Grid& grid, int cell, int goal) const {
+        int w = grid.width();
+        return Derived::template estimate<Moves>(std::abs(cell % w - goal % w), std::abs(cell / w - goal / w));
+    }
+
+    template <class Moves>
+    static constexpr int maxRise() { return Moves::kLongestStep; }
+};
+
+struct ZeroHeuristic : OffsetHeuristic<ZeroHeuristic> {
+    template <class Moves>
+    static constexpr int estimate(int, int) { return 0; }
+
+    template <class Moves>
+    static constexpr int maxRise() { return 0; }
+};
+
+// Only valid for 4-connected moves; it overestimates diagonal steps.
+struct ManhattanHeuristic : OffsetHeuristic<ManhattanHeuristic> {
+    template <class Moves>
+    static constexpr int estimate(int dx, int dy) { return Moves::kStraight * (dx + dy); }
+};
+
+struct OctileHeuristic : OffsetHeuristic<OctileHeuristic> {
+    template <class Moves>
+    static constexpr int estimate(int dx, int dy) {
+        return Moves::kStraight * (std::max(dx, dy) - std::min(dx, dy)) + Moves::kDiagonal * std::min(dx, dy);
+    }
+};
+
+// Rounded down, so the estimate never exceeds the true distance.
+struct EuclideanHeuristic : OffsetHeuristic<EuclideanHeuristic> {
+    template <class Moves>
+    static int estimate(int dx, int dy) {
+        return static_cast<int>(Moves::kStraight * std::sqrt(double(dx) * dx + double(dy) * dy));
+    }
+};
+
+// Open lists over the arena's queues. With a consistent heuristic the smallest
+// key never decreases, so the bucket queue applies. The heap takes any keys.
+class BucketOpenList {
+public:
+    explicit BucketOpenList(SearchArena& arena) : queue_(arena.buckets) {}
+
+    void reset(int maxStep, int maxHeuristicRise, int firstKey) { queue_.reset(maxStep + maxHeuristicRise + 1, firstKey); }
+    bool empty() const { return queue_.empty(); }
+    std::size_t size() const { return queue_.size(); }
+    void push(int f, int g, int index) { queue_.push(f, { index, g }); }
+
+    void pop(int& g, int& index) {
+        int f;
+        BucketQueue::Entry entry = queue_.pop(f);
+        g = entry.g;
+        index = entry.index;
+    }
+
+private:
+    BucketQueue& queue_;
+};
+
+// Ties on f go to the larger g, the deeper node.
+class HeapOpenList {
+public:
+    explicit HeapOpenList(SearchArena& arena) : queue_(arena.open) {}
+
+    void reset(int, int, int) { queue_.clear(); }
+    bool empty() const { return queue_.empty(); }
+    std::size_t size() const { return queue_.size(); }
+    void push(int f, int g, int index) { queue_.push({ f, -g, index }); }
+
+    void pop(int& g, int& index) {
+        g = -queue_.top().tie;
+        index = queue_.top().index;
+        queue_.pop();
+    }
+
+private:
+    OpenList& queue_;
+};
+
+// Calls fn(neighbourIndex, unit) for every neighbour the neighbourhood allows
+// from index, where unit is the straight or diagonal step unit. Each direction
+// is expanded at compile time.
+template <class Moves>
+class Neighbours {
+public:
+    template <class Fn>
+    static void forEach(const Grid& grid, int index, Fn&& fn) {
+        int w = grid.width();
+        int x = index % w, y = index / w;
+        visit(grid, x, y, index, fn, std::make_index_sequence<Moves::kDirections>());
+    }
+
+private:
+    template <class Fn, std::size_t... D>
+    static void visit(const Grid& grid, int x, int y, int index, Fn& fn, std::index_sequence<D...>) {
+        (step<static_cast<int>(D)>(grid, x, y, index, fn), ...);
+    }
+
+    template <int D>
+    static bool inside(const Grid& grid, int x, int y) {
+        constexpr int dx = Moves::kDx[D], dy = Moves::kDy[D];
+        if constexpr (dx < 0) { if (x == 0) return false; }
+        if constexpr (dx > 0) { if (x + 1 >= grid.width()) return false; }
+        if constexpr (dy < 0) { if (y == 0) return false; }
+        if constexpr (dy > 0) { if (y + 1 >= grid.height()) return false; }
+        return true;
+    }
+
+    template <int D, class Fn>
+    static void step(const Grid& grid, int x, int y, int index, Fn& fn) {
+        constexpr int dx = Moves::kDx[D], dy = Moves::kDy[D];
+        if (!inside<D>(grid, x, y) || grid.isWall(x + dx, y + dy)) return;
+        if constexpr (dx != 0 && dy != 0) {
+            bool openX = !grid.isWall(x + dx, y), openY = !grid.isWall(x, y + dy);
+            if constexpr (Moves::kCutCorners) { if (!openX && !openY) return; }
+            else { if (!openX || !openY) return; }
+            fn(index + dy * grid.width() + dx, Moves::kDiagonal);
+        }
+        else {
+            fn(index + dy * grid.width() + dx, Moves::kStraight);
+        }
+    }
+};
+
+// Best-first search over cell costs: Dijkstra with ZeroHeuristic, A* with any
+// other. A step costs the neighbourhood's unit times the cost of the entered
+// cell. Paths are optimal for that cost model.
+template <class Moves, class Heuristic, class Queue>
+class SearchKernel {
+    static_assert(!(std::is_same<Heuristic, ManhattanHeuristic>::value && Moves::kDirections == 8),
+        "Manhattan distance overestimates diagonal moves");
+
+public:
+    template <class Observer>
+    static SearchResult run(const Grid& grid, int start, int end, Observer& observer, SearchArena& arena,
+        const Heuristic& heuristic = Heuristic()) {
+        arena.begin(grid.cellCount());
+        Queue open(arena);
+        int h = heuristic.template between<Moves>(grid, start, end);
+        // A step raises f by its own cost plus at most the heuristic's rise.
+        open.reset(Moves::kLongestStep * Grid::kMaxCost, Heuristic::template maxRise<Moves>(), h);
+
+        arena.reach(start, 0, -1);
+        open.push(h, 0, start);
+        observer.onPhase(SearchPhase::Search);
+
+        while (!open.empty()) {
+            int g, current;
+            open.pop(g, current);
+            observer.onPop(current);
+            if (g > arena.cost(current)) {
+                observer.onStale(current);
+                continue;
+            }
+
+            if (current == end) {
+                observer.onPhase(SearchPhase::Reconstruct);
+                return reconstructPath(arena, start, end, observer);
+            }
+            observer.onExpand(current);
+
+            Neighbours<Moves>::forEach(grid, current, [&](int next, int unit) {
+                observer.onGenerate(next);
+                int tentative = g + unit * grid.cost(next);
+                if (tentative < arena.cost(next)) {
+                    arena.reach(next, tentative, current);
+                    open.push(tentative + heuristic.template between<Moves>(grid, next, end), tentative, next);
+                    observer.onVisit(next);
+                    if constexpr (Observer::enabled) observer.onOpenSize(open.size());
+                }
+                });
+        }
+        return {};
+    }
+
+private:
+    template <class Observer>
+    static SearchResult reconstructPath(const SearchArena& arena, int start, int end, Observer& observer) {
+        SearchResult result;
+        result.found = true;
+
+        for (int current = end; current != start; current = arena.parent(current)) {
+            result.path.push_back(current);
+            observer.onPath(current);
+        }
+        result.path.push_back(start);
+        std::reverse(result.path.begin(), result.path.end());
+        return result;
+    }
+};
+
+} // namespace Pathfinding
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+
+namespace Pathfinding {
+
+// Stages of one findPath call, reported through onPhase so an observer can
+// time them. Setup covers argument checks and scratch preparation, Search the
+// main loop, and Reconstruct tracing the path back; Done ends the call.
+enum class SearchPhase { Setup, Search, Reconstruct, Done };
+
+// Receives progress events from the search routines. Observers derive from this
+// and shadow the hooks they care about; calls are resolved statically, so the
+// empty defaults inline away and a plain NullObserver costs nothing.
+// Cells are reported by their linear grid index.
+//
+// Hooks whose arguments cost something to compute (onOpenSize) are only
+// called when the observer sets enabled. Not every search reports every hook;
+// the ones built on open-list loops (BFS, DFS, greedy, Dijkstra, A*, ALT, JPS)
+// report them all.
+struct NullObserver {
+    static constexpr bool enabled = false;
+
+    // A cell was discovered and added to the open list.
+    void onVisit(int) {}
+    // A cell was taken off the open list and its neighbours are about to be generated.
+    void onExpand(int) {}
+    // A cell on the final path, reported from the end back towards the start.
+    void onPath(int) {}
+
+    // A neighbour was generated during an expansion, whether or not it was queued.
+    void onGenerate(int) {}
+    // An entry was taken off the open list, stale or not.
+    void onPop(int) {}
+    // A popped entry was skipped because the cell was already reached more cheaply.
+    void onStale(int) {}
+    // Size of the open list after a push.
+    void onOpenSize(std::size_t) {}
+    void onPhase(SearchPhase) {}
+};
+
+} // namespace Pathfinding
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <vector>
+
+namespace Pathfinding {
+
+struct SearchResult {
+    bool found = false;
+    std::vector<int> path; // cell indices from start to end inclusive, empty when no path exists
+};
+
+} // namespace Pathfinding
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "SearchObserver.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace Pathfinding {
+
+// Heap bytes allocated by each thread, as far as the program reports them.
+// The core cannot replace operator new from a header, so a program that wants
+// SearchStats::bytesAllocated filled in calls record() from its own operator
+// new, as the benchmark and the visualizer do. Otherwise it stays zero.
+struct AllocationCounter {
+    static void record(std::size_t bytes) { total() += bytes; }
+
+    static std::size_t& total() {
+        static thread_local std::size_t bytes = 0;
+        return bytes;
+    }
+};
+
+// Counters and timings for one findPath call. Searches that do not report a
+// hook leave its counter at zero.
+struct SearchStats {
+    std::uint64_t expanded = 0;      // cells expanded
+    std::uint64_t generated = 0;     // neighbours generated by expansions
+    std::uint64_t pushes = 0;        // entries added to the open list, the start included
+    std::uint64_t pops = 0;          // entries taken off the open list, stale ones included
+    std::uint64_t stalePops = 0;     // popped entries skipped as out of date
+    std::size_t peakOpen = 0;        // largest open list seen
+    std::size_t bytesAllocated = 0;  // heap bytes the calling thread allocated
+    std::int64_t setupNs = 0, searchNs = 0, reconstructNs = 0;
+
+    std::int64_t totalNs() const { return setupNs + searchNs + reconstructNs; }
+};
+
+// Fills SearchStats from the observer hooks. Pass it to findPath in place of
+// NullObserver; timings come from the phase marks, so they cover one call
+// made through Pathfinder::findPath. Instrumented builds pay for the counters
+// and four clock reads per call; NullObserver callers compile all of it away.
+class StatsObserver : public NullObserver {
+public:
+    static constexpr bool enabled = true;
+
+    const SearchStats& stats() const { return stats_; }
+
+    void onVisit(int) { ++stats_.pushes; }
+    void onExpand(int) { ++stats_.expanded; }
+    void onGenerate(int) { ++stats_.generated; }
+    void onPop(int) { ++stats_.pops; }
+    void onStale(int) { ++stats_.stalePops; }
+    void onOpenSize(std::size_t size) { if (size > stats_.peakOpen) stats_.peakOpen = size; }
+
+    void onPhase(SearchPhase phase) {
+        int i = static_cast<int>(phase);
+        marks_[i] = Clock::now();
+        seen_[i] = true;
+        if (phase == SearchPhase::Setup) {
+            stats_ = SearchStats();
+            stats_.pushes = 1; // the start cell is pushed without a visit event
+            seen_[1] = seen_[2] = false;
+            allocatedBefore_ = AllocationCounter::total();
+        }
+        else if (phase == SearchPhase::Done) {
+            // A search that does not mark its own phases counts as all search.
+            Clock::time_point search = seen_[1] ? marks_[1] : marks_[0];
+            Clock::time_point reconstruct = seen_[2] ? marks_[2] : marks_[3];
+            stats_.setupNs = nanoseconds(marks_[0], search);
+            stats_.searchNs = nanoseconds(search, reconstruct);
+            stats_.reconstructNs = nanoseconds(reconstruct, marks_[3]);
+            stats_.bytesAllocated = AllocationCounter::total() - allocatedBefore_;
+        }
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    static std::int64_t nanoseconds(Clock::time_point from, Clock::time_point to) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(to - from).count();
+    }
+
+    SearchStats stats_;
+    Clock::time_point marks_[4];  // indexed by SearchPhase
+    bool seen_[4] = {};
+    std::size_t allocatedBefore_ = 0;
+};
+
+// Forwards every hook to two observers, e.g. a StatsObserver alongside the
+// visualizer's event queue.
+template <class First, class Second>
+class TeeObserver {
+public:
+    static constexpr bool enabled = First::enabled || Second::enabled;
+
+    TeeObserver(First& first, Second& second) : first_(first), second_(second) {}
+
+    void onVisit(int index) { first_.onVisit(index); second_.onVisit(index); }
+    void onExpand(int index) { first_.onExpand(index); second_.onExpand(index); }
+    void onPath(int index) { first_.onPath(index); second_.onPath(index); }
+    void onGenerate(int index) { first_.onGenerate(index); second_.onGenerate(index); }
+    void onPop(int index) { first_.onPop(index); second_.onPop(index); }
+    void onStale(int index) { first_.onStale(index); second_.onStale(index); }
+    void onOpenSize(std::size_t size) { first_.onOpenSize(size); second_.onOpenSize(size); }
+    void onPhase(SearchPhase phase) { first_.onPhase(phase); second_.onPhase(phase); }
+
+private:
+    First& first_;
+    Second& second_;
+};
+
+} // namespace Pathfinding
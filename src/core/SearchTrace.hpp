@@ -0,0 +1,256 @@
+#pragma once
+
+#include "Grid.hpp"
+#include "MappedFile.hpp"
+#include "SearchEvent.hpp"
+#include "SearchObserver.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace Pathfinding {
+
+// Expansion traces record the Visit and Path events of one search on disk, so
+// the search can be replayed later without running it again.
+//
+// File layout, native byte order: a Header, the walls (one bit per cell in
+// index order, padded to a whole byte), the events, the keyframe table and a
+// Trailer. Each event is one varint: the zigzagged difference between its cell
+// and the previous event's cell, shifted left once, with the low bit set for a
+// Path event. Every kKeyframeInterval-th event is coded against cell 0 instead,
+// and its byte offset goes into the keyframe table, so decoding can start at
+// any keyframe. Searches mostly report cells close to the previous one, so
+// most events take one or two bytes.
+struct TraceFormat {
+    static constexpr std::uint32_t kVersion = 1;
+    static constexpr std::uint32_t kKeyframeInterval = 4096;
+
+    struct Header {
+        char magic[4];  // "PFTR"
+        std::uint32_t format;
+        std::int32_t width, height, start, goal;
+        std::uint32_t keyframeInterval;
+    };
+
+    struct Trailer {
+        std::uint64_t events;
+        std::uint64_t keyframeTable;  // byte offset of the table
+        std::uint32_t keyframes;
+        char magic[4];  // "PFTE"
+    };
+
+    static std::size_t wallBytes(std::int32_t width, std::int32_t height) {
+        return (static_cast<std::size_t>(width) * height + 7) / 8;
+    }
+};
+
+// Observer that streams a trace to disk while the search runs. Events are
+// buffered and written in blocks, and only the keyframe offsets stay in
+// memory, so a trace can be far larger than the memory the writer uses. Pair
+// it with other observers through TeeObserver.
+class TraceWriter : public NullObserver {
+public:
+    // Records the walls as they are now. Throws if the file cannot be created.
+    TraceWriter(const std::string& path, const Grid& grid, int start, int goal) : out_(path, std::ios::binary) {
+        if (!out_) throw std::runtime_error("Cannot write trace file: " + path);
+
+        TraceFormat::Header header{ { 'P', 'F', 'T', 'R' }, TraceFormat::kVersion, grid.width(), grid.height(), start, goal,
+            TraceFormat::kKeyframeInterval };
+        write(&header, sizeof(header));
+
+        std::vector<char> walls(TraceFormat::wallBytes(grid.width(), grid.height()), 0);
+        for (int cell = 0; cell < grid.cellCount(); ++cell) {
+            if (grid.isWall(cell)) walls[cell >> 3] |= static_cast<char>(1 << (cell & 7));
+        }
+        write(walls.data(), walls.size());
+        buffer_.reserve(kBufferSize + 16);
+    }
+
+    TraceWriter(const TraceWriter&) = delete;
+    TraceWriter& operator=(const TraceWriter&) = delete;
+
+    ~TraceWriter() { close(); }
+
+    void onVisit(int index) { append(index, 0); }
+    void onPath(int index) { append(index, 1); }
+
+    std::uint64_t events() const { return events_; }
+
+    // Writes the buffered events and the keyframe table. Later events are
+    // ignored. Returns false if any write failed.
+    bool close() {
+        if (closed_) return ok_;
+        closed_ = true;
+
+        flush();
+        TraceFormat::Trailer trailer{ events_, written_, static_cast<std::uint32_t>(keyframes_.size()), { 'P', 'F', 'T', 'E' } };
+        write(keyframes_.data(), keyframes_.size() * sizeof(std::uint64_t));
+        write(&trailer, sizeof(trailer));
+        out_.close();
+        ok_ = ok_ && !out_.fail();
+        return ok_;
+    }
+
+private:
+    static constexpr std::size_t kBufferSize = 1 << 16;
+
+    void append(int index, std::uint64_t path) {
+        if (closed_) return;
+        if (events_ % TraceFormat::kKeyframeInterval == 0) {
+            keyframes_.push_back(written_ + buffer_.size());
+            previous_ = 0;
+        }
+        std::int64_t delta = std::int64_t(index) - previous_;
+        std::uint64_t value = (static_cast<std::uint64_t>(delta) << 1 ^ static_cast<std::uint64_t>(delta >> 63)) << 1 | path;
+        while (value >= 0x80) {
+            buffer_.push_back(static_cast<char>(value | 0x80));
+            value >>= 7;
+        }
+        buffer_.push_back(static_cast<char>(value));
+        previous_ = index;
+        ++events_;
+        if (buffer_.size() >= kBufferSize) flush();
+    }
+
+    void flush() {
+        write(buffer_.data(), buffer_.size());
+        buffer_.clear();
+    }
+
+    void write(const void* data, std::size_t bytes) {
+        out_.write(static_cast<const char*>(data), static_cast<std::streamsize>(bytes));
+        written_ += bytes;
+        ok_ = ok_ && !out_.fail();
+    }
+
+    std::ofstream out_;
+    std::vector<char> buffer_;
+    std::vector<std::uint64_t> keyframes_;  // byte offset of every kKeyframeInterval-th event
+    std::uint64_t written_ = 0;             // bytes handed to out_
+    std::uint64_t events_ = 0;
+    int previous_ = 0;
+    bool ok_ = true;
+    bool closed_ = false;
+};
+
+// Reads a trace through a memory mapping, so only the pages being decoded
+// are resident. at(step) starts from the keyframe at or before step and
+// skips fewer than kKeyframeInterval events, so any step is reached in
+// constant time however long the trace is.
+class TraceReader {
+public:
+    // Throws if the file is missing, truncated or not a trace.
+    explicit TraceReader(const std::string& path) : file_(path) {
+        const std::uint8_t* data = file_.data();
+        std::size_t size = file_.size();
+        auto fail = [&]() { return std::runtime_error("Not a valid trace file: " + path); };
+
+        if (size < sizeof(TraceFormat::Header) + sizeof(TraceFormat::Trailer)) throw fail();
+        std::memcpy(&header_, data, sizeof(header_));
+        std::memcpy(&trailer_, data + size - sizeof(trailer_), sizeof(trailer_));
+        if (std::memcmp(header_.magic, "PFTR", 4) != 0 || std::memcmp(trailer_.magic, "PFTE", 4) != 0) throw fail();
+        if (header_.format != TraceFormat::kVersion || header_.width <= 0 || header_.height <= 0 || header_.keyframeInterval == 0) {
+            throw fail();
+        }
+
+        eventsBegin_ = sizeof(header_) + TraceFormat::wallBytes(header_.width, header_.height);
+        std::uint64_t expectedKeyframes = (trailer_.events + header_.keyframeInterval - 1) / header_.keyframeInterval;
+        if (trailer_.keyframes != expectedKeyframes || trailer_.keyframeTable < eventsBegin_ ||
+            trailer_.keyframeTable + trailer_.keyframes * sizeof(std::uint64_t) + sizeof(trailer_) != size) {
+            throw fail();
+        }
+        for (std::uint32_t k = 0; k < trailer_.keyframes; ++k) {
+            std::uint64_t offset = keyframe(k);
+            if (offset < eventsBegin_ || offset >= trailer_.keyframeTable) throw fail();
+        }
+    }
+
+    int width() const { return header_.width; }
+    int height() const { return header_.height; }
+    int cellCount() const { return header_.width * header_.height; }
+    int start() const { return header_.start; }
+    int goal() const { return header_.goal; }
+
+    // Number of events in the trace.
+    std::uint64_t size() const { return trailer_.events; }
+
+    bool isWall(int cell) const { return file_.data()[sizeof(header_) + (cell >> 3)] >> (cell & 7) & 1; }
+
+    // Decodes events in order from a given step.
+    class Cursor {
+    public:
+        // Stops at the end of the trace and at any event that does not decode
+        // to a cell of the grid.
+        bool next(SearchEvent& event) {
+            if (step_ >= reader_->size()) return false;
+            if (step_ % reader_->header_.keyframeInterval == 0) previous_ = 0;
+
+            std::uint64_t value = 0;
+            for (int shift = 0;; shift += 7) {
+                if (pos_ == end_ || shift > 63) return false;
+                std::uint8_t byte = *pos_++;
+                value |= std::uint64_t(byte & 0x7f) << shift;
+                if (!(byte & 0x80)) break;
+            }
+            std::uint64_t zigzag = value >> 1;
+            std::int64_t index = previous_ + static_cast<std::int64_t>(zigzag >> 1 ^ (~(zigzag & 1) + 1));
+            if (index < 0 || index >= reader_->cellCount()) return false;
+
+            event.type = value & 1 ? SearchEvent::Type::Path : SearchEvent::Type::Visit;
+            event.index = static_cast<int>(index);
+            previous_ = event.index;
+            ++step_;
+            return true;
+        }
+
+        // Step of the event next() returns.
+        std::uint64_t step() const { return step_; }
+
+    private:
+        friend class TraceReader;
+
+        const TraceReader* reader_ = nullptr;
+        const std::uint8_t* pos_ = nullptr;
+        const std::uint8_t* end_ = nullptr;
+        std::uint64_t step_ = 0;
+        int previous_ = 0;
+    };
+
+    // Cursor at step, clamped to the end of the trace.
+    Cursor at(std::uint64_t step) const {
+        Cursor cursor;
+        cursor.reader_ = this;
+        cursor.end_ = file_.data() + trailer_.keyframeTable;
+        if (step >= size()) {
+            cursor.pos_ = cursor.end_;
+            cursor.step_ = size();
+            return cursor;
+        }
+
+        std::uint64_t k = step / header_.keyframeInterval;
+        cursor.pos_ = file_.data() + keyframe(static_cast<std::uint32_t>(k));
+        cursor.step_ = k * header_.keyframeInterval;
+        SearchEvent skipped;
+        while (cursor.step_ < step && cursor.next(skipped)) {}
+        return cursor;
+    }
+
+private:
+    std::uint64_t keyframe(std::uint32_t k) const {
+        std::uint64_t offset;
+        std::memcpy(&offset, file_.data() + trailer_.keyframeTable + k * sizeof(std::uint64_t), sizeof(offset));
+        return offset;
+    }
+
+    MappedFile file_;
+    TraceFormat::Header header_;
+    TraceFormat::Trailer trailer_;
+    std::uint64_t eventsBegin_ = 0;
+};
+
+} // namespace Pathfinding
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace Pathfinding {
+
+// Bounded lock-free ring buffer for exactly one producer thread and one consumer
+// thread. Each side caches the other side's index and only reloads it when the
+// ring looks full (or empty), so the shared cache lines are touched rarely.
+template <class T>
+class SpscQueue {
+public:
+    explicit SpscQueue(std::size_t capacity) {
+        std::size_t size = 1;
+        while (size < capacity) size <<= 1;
+        buffer_.resize(size);
+        mask_ = size - 1;
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    std::size_t capacity() const { return buffer_.size(); }
+
+    // Producer side. Returns false when the ring is full.
+    bool tryPush(const T& item) {
+        std::size_t head = head_.load(std::memory_order_relaxed);
+        if (head - tailCache_ == buffer_.size()) {
+            tailCache_ = tail_.load(std::memory_order_acquire);
+            if (head - tailCache_ == buffer_.size()) return false;
+        }
+        buffer_[head & mask_] = item;
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side. Returns false when the ring is empty.
+    bool tryPop(T& item) {
+        std::size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail == headCache_) {
+            headCache_ = head_.load(std::memory_order_acquire);
+            if (tail == headCache_) return false;
+        }
+        item = buffer_[tail & mask_];
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side. Hands every item currently in the ring to fn and releases
+    // the slots in one store; returns the number of items consumed.
+    template <class Fn>
+    std::size_t drain(Fn&& fn) {
+        std::size_t tail = tail_.load(std::memory_order_relaxed);
+        headCache_ = head_.load(std::memory_order_acquire);
+        for (std::size_t i = tail; i != headCache_; ++i) fn(buffer_[i & mask_]);
+        tail_.store(headCache_, std::memory_order_release);
+        return headCache_ - tail;
+    }
+
+private:
+    std::vector<T> buffer_;
+    std::size_t mask_ = 0;
+
+    alignas(64) std::atomic<std::size_t> head_{ 0 }; // written by the producer
+    std::size_t tailCache_ = 0;                       // producer's view of tail_
+    alignas(64) std::atomic<std::size_t> tail_{ 0 }; // written by the consumer
+    std::size_t headCache_ = 0;                       // consumer's view of head_
+};
+
+} // namespace Pathfinding
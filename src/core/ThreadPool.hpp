@@ -0,0 +1,183 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Pathfinding {
+
+// Fixed-size pool for data-parallel loops. parallelFor splits the index range
+// evenly across the workers. A worker that runs out of work steals the upper
+// half of another worker's remaining range. Each range is one atomic word
+// holding [lo, hi), so claiming an index and stealing a half are each a single
+// compare-and-swap. The calling thread takes part as worker 0.
+//
+// One loop runs at a time: concurrent parallelFor calls are serialised, and the
+// loop body must not call parallelFor on the same pool.
+class ThreadPool {
+public:
+    explicit ThreadPool(unsigned threads = std::thread::hardware_concurrency())
+        : size_(std::max(1u, threads)), ranges_(new Range[size_]) {
+        for (unsigned id = 1; id < size_; ++id) {
+            workers_.emplace_back([this, id]() { workerLoop(id); });
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_all();
+        for (std::thread& worker : workers_) worker.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Process-wide pool that the shared caches build on, so rebuilds of
+    // different caches reuse one set of threads rather than each starting
+    // its own. Loops on it are serialised like any other pool's.
+    static ThreadPool& shared() {
+        static ThreadPool pool;
+        return pool;
+    }
+
+    // Number of workers, counting the calling thread.
+    unsigned size() const { return size_; }
+
+    // Calls fn(index, worker) once for every index in [0, count) and returns
+    // when all calls have finished. worker is in [0, size()) and no two calls
+    // with the same worker run at the same time, so it can select per-thread
+    // scratch state.
+    template <class Fn>
+    void parallelFor(std::size_t count, Fn&& fn) {
+        std::lock_guard<std::mutex> submit(submit_);
+        // Ranges hold 32-bit bounds; larger loops run as consecutive slices.
+        constexpr std::size_t kSlice = 0xffffffffu;
+        for (std::size_t offset = 0; offset < count; offset += kSlice) {
+            Slice<Fn> slice{ fn, offset };
+            run(static_cast<std::uint32_t>(std::min(kSlice, count - offset)), &Slice<Fn>::call, &slice);
+        }
+    }
+
+private:
+    using Call = void (*)(void* context, std::size_t index, unsigned worker);
+
+    template <class Fn>
+    struct Slice {
+        Fn& fn;
+        std::size_t offset;
+
+        static void call(void* context, std::size_t index, unsigned worker) {
+            Slice& self = *static_cast<Slice*>(context);
+            self.fn(self.offset + index, worker);
+        }
+    };
+
+    struct alignas(64) Range {
+        std::atomic<std::uint64_t> bounds{ 0 }; // hi << 32 | lo
+    };
+
+    static std::uint64_t pack(std::uint32_t lo, std::uint32_t hi) { return (std::uint64_t(hi) << 32) | lo; }
+    static std::uint32_t low(std::uint64_t bounds) { return static_cast<std::uint32_t>(bounds); }
+    static std::uint32_t high(std::uint64_t bounds) { return static_cast<std::uint32_t>(bounds >> 32); }
+
+    void run(std::uint32_t count, Call call, void* context) {
+        for (unsigned id = 0; id < size_; ++id) {
+            std::uint32_t lo = static_cast<std::uint32_t>(std::uint64_t(count) * id / size_);
+            std::uint32_t hi = static_cast<std::uint32_t>(std::uint64_t(count) * (id + 1) / size_);
+            ranges_[id].bounds.store(pack(lo, hi));
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            call_ = call;
+            context_ = context;
+            pending_ = size_ - 1;
+            ++generation_;
+        }
+        wake_.notify_all();
+
+        work(0);
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_.wait(lock, [this]() { return pending_ == 0; });
+    }
+
+    void workerLoop(unsigned id) {
+        std::uint64_t seen = 0;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                wake_.wait(lock, [&]() { return stopping_ || generation_ != seen; });
+                if (stopping_) return;
+                seen = generation_;
+            }
+            work(id);
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (--pending_ == 0) done_.notify_one();
+            }
+        }
+    }
+
+    void work(unsigned id) {
+        std::uint32_t index;
+        while (claim(id, index) || (steal(id) && claim(id, index))) {
+            call_(context_, index, id);
+        }
+    }
+
+    // Takes the lowest unclaimed index of the worker's own range.
+    bool claim(unsigned id, std::uint32_t& index) {
+        std::atomic<std::uint64_t>& bounds = ranges_[id].bounds;
+        std::uint64_t current = bounds.load();
+        while (low(current) < high(current)) {
+            if (bounds.compare_exchange_weak(current, pack(low(current) + 1, high(current)))) {
+                index = low(current);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Moves the upper half of some other worker's range into the worker's own,
+    // which is empty at this point. Indices are never handed out twice, so a
+    // thief's stale compare-and-swap cannot succeed on a reused value.
+    bool steal(unsigned id) {
+        for (unsigned k = 1; k < size_; ++k) {
+            std::atomic<std::uint64_t>& victim = ranges_[(id + k) % size_].bounds;
+            std::uint64_t current = victim.load();
+            while (low(current) < high(current)) {
+                std::uint32_t lo = low(current), hi = high(current);
+                std::uint32_t mid = lo + (hi - lo) / 2;
+                if (victim.compare_exchange_weak(current, pack(lo, mid))) {
+                    ranges_[id].bounds.store(pack(mid, hi));
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    unsigned size_;
+    std::unique_ptr<Range[]> ranges_;
+    std::vector<std::thread> workers_;
+
+    std::mutex submit_;
+    std::mutex mutex_;
+    std::condition_variable wake_, done_;
+    std::uint64_t generation_ = 0;
+    unsigned pending_ = 0;
+    bool stopping_ = false;
+    Call call_ = nullptr;
+    void* context_ = nullptr;
+};
+
+} // namespace Pathfinding
@@ -0,0 +1,253 @@
+#pragma once
+
+#include "Grid.hpp"
+#include "MappedFile.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace Pathfinding {
+
+// Tiled maps keep every cell in 2 bits on disk, so a 100k x 100k map takes
+// 2.5 GB, and are read a tile at a time. A cell's 2-bit code indexes a cost
+// table in the header, where cost 0 marks a wall.
+//
+// File layout, native byte order: a Header, zero padding up to kDataOffset,
+// then the tiles in row-major tile order. A tile is kTileSize rows of
+// kWordsPerTileRow words, with cell x of a row at bits 2x..2x+1 of word x / 32.
+// Cells of edge tiles past the map are zero. Tiles start on page boundaries,
+// so each can be mapped and released on its own.
+struct TiledFormat {
+    static constexpr std::uint32_t kVersion = 1;
+    static constexpr int kTileShift = 8;
+    static constexpr int kTileSize = 1 << kTileShift;  // cells per tile side
+    static constexpr int kWordsPerTileRow = kTileSize / 32;
+    static constexpr std::size_t kTileBytes = std::size_t(kTileSize) * kTileSize / 4;  // 16 KB
+    static constexpr std::size_t kDataOffset = 4096;
+
+    struct Header {
+        char magic[4];  // "PFTG"
+        std::uint32_t format;
+        std::int32_t width, height;
+        std::int32_t tileSize;
+        std::uint8_t costs[4];  // cost of each code, 0 for a wall
+    };
+
+    // Open, wall, and two grades of rough terrain.
+    static constexpr std::array<std::uint8_t, 4> kDefaultCosts = { 1, 0, 3, 9 };
+
+    static int tilesAcross(int cells) { return (cells + kTileSize - 1) / kTileSize; }
+    static int wordsPerRow(int width) { return tilesAcross(width) * kWordsPerTileRow; }
+};
+
+struct TileCacheStats {
+    std::uint64_t lookups = 0;     // requests for a tile other than the last one used
+    std::uint64_t hits = 0;        // ... that found it in the cache
+    std::uint64_t faults = 0;      // ... that had to read it from the file
+    std::uint64_t evictions = 0;
+    std::uint64_t prefetches = 0;  // neighbouring tiles the OS was asked to read ahead
+
+    double hitRate() const { return lookups ? double(hits) / double(lookups) : 1.0; }
+};
+
+// Read-only map far larger than RAM. The file is memory mapped, and tiles are
+// copied into a fixed number of cache slots on first use and evicted least
+// recently used first. A copied tile's pages are released from the mapping,
+// so resident memory stays at the cache size however much of the map a
+// search touches. Each fault also asks the OS to read the surrounding tiles
+// ahead, since a search that leaves one tile soon reaches its neighbours.
+//
+// Accessors update the cache, so they are not const, and one TiledGrid serves
+// one thread.
+class TiledGrid {
+public:
+    using Format = TiledFormat;
+
+    // Throws if the file is missing, truncated or not a tiled map.
+    explicit TiledGrid(const std::string& path, std::size_t cacheBytes = std::size_t(256) << 20) : file_(path) {
+        auto fail = [&]() { return std::runtime_error("Not a valid tiled map: " + path); };
+        if (file_.size() < Format::kDataOffset) throw fail();
+        std::memcpy(&header_, file_.data(), sizeof(header_));
+        if (std::memcmp(header_.magic, "PFTG", 4) != 0 || header_.format != Format::kVersion || header_.width <= 0 ||
+            header_.height <= 0 || header_.tileSize != Format::kTileSize) {
+            throw fail();
+        }
+        tilesX_ = Format::tilesAcross(header_.width);
+        tilesY_ = Format::tilesAcross(header_.height);
+        std::size_t tiles = std::size_t(tilesX_) * tilesY_;
+        if (file_.size() != Format::kDataOffset + tiles * Format::kTileBytes) throw fail();
+
+        std::size_t capacity = std::max<std::size_t>(9, std::min(tiles, cacheBytes / Format::kTileBytes));
+        slots_.resize(capacity * (Format::kTileBytes / sizeof(std::uint64_t)));
+        tileOf_.assign(capacity, -1);
+        newer_.assign(capacity, -1);
+        older_.assign(capacity, -1);
+        slotOf_.assign(tiles, -1);
+    }
+
+    TiledGrid(const TiledGrid&) = delete;
+    TiledGrid& operator=(const TiledGrid&) = delete;
+
+    int width() const { return header_.width; }
+    int height() const { return header_.height; }
+    std::int64_t cellCount() const { return std::int64_t(header_.width) * header_.height; }
+    bool inBounds(int x, int y) const { return x >= 0 && x < header_.width && y >= 0 && y < header_.height; }
+
+    int code(int x, int y) {
+        int tile = (y >> Format::kTileShift) * tilesX_ + (x >> Format::kTileShift);
+        if (tile != lastTile_) use(tile);
+        int lx = x & (Format::kTileSize - 1), ly = y & (Format::kTileSize - 1);
+        return (lastWords_[ly * Format::kWordsPerTileRow + (lx >> 5)] >> ((lx & 31) * 2)) & 3;
+    }
+
+    bool isWall(int x, int y) { return header_.costs[code(x, y)] == 0; }
+    // Cost of entering an open cell.
+    int cost(int x, int y) { return header_.costs[code(x, y)]; }
+
+    const TileCacheStats& cacheStats() const { return stats_; }
+    void resetCacheStats() { stats_ = TileCacheStats(); }
+    std::size_t cacheBytes() const { return slots_.size() * sizeof(std::uint64_t); }
+
+    // Streams a map to path one row of tiles at a time, so memory stays at
+    // one tile row however large the map. fill(y, words) stores row y as
+    // Format::wordsPerRow(width) words, 32 cells to a word; bits past the width
+    // must be zero. Throws if the file cannot be written.
+    template <class RowFn>
+    static void write(const std::string& path, int width, int height, RowFn&& fill,
+        const std::array<std::uint8_t, 4>& costs = Format::kDefaultCosts) {
+        std::ofstream out(path, std::ios::binary);
+        if (!out) throw std::runtime_error("Cannot write tiled map: " + path);
+
+        Format::Header header{ { 'P', 'F', 'T', 'G' }, Format::kVersion, width, height, Format::kTileSize,
+            { costs[0], costs[1], costs[2], costs[3] } };
+        std::vector<char> head(Format::kDataOffset, 0);
+        std::memcpy(head.data(), &header, sizeof(header));
+        out.write(head.data(), static_cast<std::streamsize>(head.size()));
+
+        int tilesX = Format::tilesAcross(width), wordsPerRow = Format::wordsPerRow(width);
+        std::size_t tileWords = Format::kTileBytes / sizeof(std::uint64_t);
+        std::vector<std::uint64_t> row(wordsPerRow), band(tileWords * tilesX);
+        for (int y0 = 0; y0 < height; y0 += Format::kTileSize) {
+            std::fill(band.begin(), band.end(), 0);
+            for (int ly = 0; ly < Format::kTileSize && y0 + ly < height; ++ly) {
+                std::fill(row.begin(), row.end(), 0);
+                fill(y0 + ly, row.data());
+                for (int tx = 0; tx < tilesX; ++tx) {
+                    std::copy_n(row.begin() + std::size_t(tx) * Format::kWordsPerTileRow, Format::kWordsPerTileRow,
+                        band.begin() + tx * tileWords + std::size_t(ly) * Format::kWordsPerTileRow);
+                }
+            }
+            out.write(reinterpret_cast<const char*>(band.data()), static_cast<std::streamsize>(band.size() * sizeof(std::uint64_t)));
+        }
+        if (!out.flush()) throw std::runtime_error("Cannot write tiled map: " + path);
+    }
+
+    // Writes an in-memory grid as a tiled map. Each open cell takes the code
+    // whose cost is nearest its own.
+    static void write(const std::string& path, const Grid& grid, const std::array<std::uint8_t, 4>& costs = Format::kDefaultCosts) {
+        int wallCode = 0, codeOf[Grid::kMaxCost + 1] = {};
+        for (int code = 0; code < 4; ++code) {
+            if (costs[code] == 0) wallCode = code;
+        }
+        for (int cost = 1; cost <= Grid::kMaxCost; ++cost) {
+            int best = -1;
+            for (int code = 0; code < 4; ++code) {
+                if (costs[code] != 0 && (best < 0 || std::abs(costs[code] - cost) < std::abs(costs[best] - cost))) best = code;
+            }
+            codeOf[cost] = best < 0 ? wallCode : best;
+        }
+        write(path, grid.width(), grid.height(), [&](int y, std::uint64_t* words) {
+            for (int x = 0; x < grid.width(); ++x) {
+                std::uint64_t code = grid.isWall(x, y) ? wallCode : codeOf[grid.cost(x, y)];
+                words[x >> 5] |= code << ((x & 31) * 2);
+            }
+            }, costs);
+    }
+
+private:
+    std::size_t tileOffset(int tile) const { return Format::kDataOffset + std::size_t(tile) * Format::kTileBytes; }
+    std::uint64_t* slot(int s) { return slots_.data() + std::size_t(s) * (Format::kTileBytes / sizeof(std::uint64_t)); }
+
+    void use(int tile) {
+        ++stats_.lookups;
+        int s = slotOf_[tile];
+        if (s >= 0) {
+            ++stats_.hits;
+            unlink(s);
+        }
+        else {
+            ++stats_.faults;
+            s = load(tile);
+        }
+        pushNewest(s);
+        lastTile_ = tile;
+        lastWords_ = slot(s);
+    }
+
+    int load(int tile) {
+        int s;
+        if (used_ < static_cast<int>(tileOf_.size())) s = used_++;
+        else {
+            s = oldest_;
+            unlink(s);
+            slotOf_[tileOf_[s]] = -1;
+            ++stats_.evictions;
+        }
+        tileOf_[s] = tile;
+        slotOf_[tile] = s;
+        std::memcpy(slot(s), file_.data() + tileOffset(tile), Format::kTileBytes);
+        file_.dontNeed(tileOffset(tile), Format::kTileBytes);
+
+        int tx = tile % tilesX_, ty = tile / tilesX_;
+        for (int dy = -1; dy <= 1; ++dy) {
+            for (int dx = -1; dx <= 1; ++dx) {
+                int nx = tx + dx, ny = ty + dy;
+                if ((dx == 0 && dy == 0) || nx < 0 || nx >= tilesX_ || ny < 0 || ny >= tilesY_) continue;
+                int neighbour = ny * tilesX_ + nx;
+                if (slotOf_[neighbour] >= 0) continue;
+                file_.willNeed(tileOffset(neighbour), Format::kTileBytes);
+                ++stats_.prefetches;
+            }
+        }
+        return s;
+    }
+
+    // Recency list over the slots, newest first.
+    void unlink(int s) {
+        if (newer_[s] >= 0) older_[newer_[s]] = older_[s];
+        else newest_ = older_[s];
+        if (older_[s] >= 0) newer_[older_[s]] = newer_[s];
+        else oldest_ = newer_[s];
+    }
+
+    void pushNewest(int s) {
+        newer_[s] = -1;
+        older_[s] = newest_;
+        if (newest_ >= 0) newer_[newest_] = s;
+        newest_ = s;
+        if (oldest_ < 0) oldest_ = s;
+    }
+
+    MappedFile file_;
+    Format::Header header_;
+    int tilesX_ = 0, tilesY_ = 0;
+
+    std::vector<std::uint64_t> slots_;     // cached tiles, kTileBytes each
+    std::vector<int> tileOf_;              // tile held by each slot
+    std::vector<int> newer_, older_;       // recency links between slots
+    std::vector<int> slotOf_;              // slot holding each tile, or -1
+    int used_ = 0, newest_ = -1, oldest_ = -1;
+    int lastTile_ = -1;
+    const std::uint64_t* lastWords_ = nullptr;
+    TileCacheStats stats_;
+};
+
+} // namespace Pathfinding
@@ -0,0 +1,276 @@
+#pragma once
+
+#include "Grid.hpp"
+#include "SearchKernel.hpp"
+#include "TiledGrid.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace Pathfinding {
+
+struct TiledSearchResult {
+    bool found = false;
+    std::vector<Point> path;  // start to end inclusive, empty when no path exists
+    std::int64_t cost = 0;    // in the neighbourhood's step units
+    std::uint64_t expanded = 0;
+    std::size_t stateBytes = 0;  // peak search memory: touched state blocks and the open list
+    bool truncated = false;      // gave up on reaching maxStateBytes, so found says nothing
+    TileCacheStats cache;        // tile traffic of this search alone
+};
+
+// BFS, Dijkstra and A* over a TiledGrid. They follow the in-memory searches
+// step for step and share their neighbourhood and heuristic policies, but
+// cells are addressed by 64-bit ids, since a map this size overflows the
+// int32 indices of Grid, and per-cell state lives in 64x64 blocks allocated
+// as the search first touches them rather than in a dense SearchArena. A
+// search therefore holds memory in proportion to the area it explores, not
+// the map.
+//
+// There is no component index out here: a goal the start cannot reach makes
+// the search flood the start's whole component. An optimal search may also
+// have to explore most of the map when no path comes close to the heuristic.
+// Either way it needs about 5 bytes per cell reached, so every search takes
+// a cap on its memory, maxStateBytes, where 0 means no cap.
+class TiledSearch {
+public:
+    static TiledSearchResult bfs(TiledGrid& grid, Point start, Point end, std::size_t maxStateBytes = 0) {
+        TiledSearchResult result;
+        TileCacheStats before = grid.cacheStats();
+        if (!endpointsValid(grid, start, end)) return result;
+        State state(grid);
+
+        std::deque<std::int64_t> queue;
+        state.reach(start.x, start.y, 0, kStart);
+        queue.push_back(state.id(start.x, start.y));
+        std::size_t peakQueue = 1;
+        std::uint64_t expanded = 0;
+
+        while (!queue.empty()) {
+            std::int64_t current = queue.front();
+            queue.pop_front();
+            int x = state.x(current), y = state.y(current);
+            if (x == end.x && y == end.y) {
+                result = state.trace<FourConnected>(start, end);
+                break;
+            }
+            ++expanded;
+            forEachNeighbour<FourConnected>(grid, x, y, [&](int nx, int ny, int d, int) {
+                if (state.reached(nx, ny)) return;
+                state.reach(nx, ny, state.g(x, y) + 1, d);
+                queue.push_back(state.id(nx, ny));
+                });
+            peakQueue = std::max(peakQueue, queue.size());
+            if (overBudget(state, peakQueue * sizeof(std::int64_t), maxStateBytes, result)) break;
+        }
+        finish(grid, before, state, expanded, peakQueue * sizeof(std::int64_t), result);
+        return result;
+    }
+
+    template <class Moves>
+    static TiledSearchResult dijkstra(TiledGrid& grid, Point start, Point end, std::size_t maxStateBytes = 0) {
+        return bestFirst<Moves, ZeroHeuristic>(grid, start, end, maxStateBytes);
+    }
+
+    template <class Moves, class Heuristic>
+    static TiledSearchResult aStar(TiledGrid& grid, Point start, Point end, std::size_t maxStateBytes = 0) {
+        return bestFirst<Moves, Heuristic>(grid, start, end, maxStateBytes);
+    }
+
+private:
+    static constexpr std::uint8_t kUnreached = 0xff;
+    static constexpr std::uint8_t kStart = 0xfe;
+
+    // g and the direction each cell was entered by, in 64x64 blocks.
+    class State {
+    public:
+        explicit State(const TiledGrid& grid)
+            : width_(grid.width()), blocksX_((grid.width() + kBlock - 1) / kBlock),
+            blocks_(std::size_t(blocksX_) * ((grid.height() + kBlock - 1) / kBlock)) {}
+
+        std::int64_t id(int x, int y) const { return std::int64_t(y) * width_ + x; }
+        int x(std::int64_t id) const { return static_cast<int>(id % width_); }
+        int y(std::int64_t id) const { return static_cast<int>(id / width_); }
+
+        bool reached(int x, int y) const { return direction(x, y) != kUnreached; }
+        int g(int x, int y) const {
+            const Block* block = find(x, y);
+            return block && block->from[offset(x, y)] != kUnreached ? block->g[offset(x, y)] : std::numeric_limits<int>::max();
+        }
+        std::uint8_t direction(int x, int y) const {
+            const Block* block = find(x, y);
+            return block ? block->from[offset(x, y)] : kUnreached;
+        }
+
+        void reach(int x, int y, int g, std::uint8_t from) {
+            std::unique_ptr<Block>& block = blocks_[index(x, y)];
+            if (!block) {
+                block.reset(new Block);
+                std::fill(std::begin(block->from), std::end(block->from), kUnreached);
+                ++allocated_;
+            }
+            block->g[offset(x, y)] = g;
+            block->from[offset(x, y)] = from;
+        }
+
+        std::size_t bytes() const { return allocated_ * sizeof(Block) + blocks_.size() * sizeof(blocks_[0]); }
+
+        // Walks the entry directions back from end. Direction d means the cell
+        // was entered by a step of Moves d; cells keep the policy's order.
+        template <class Moves>
+        TiledSearchResult trace(Point start, Point end) const {
+            TiledSearchResult result;
+            result.found = true;
+            result.cost = g(end.x, end.y);
+            for (Point p = end; !(p == start);) {
+                result.path.push_back(p);
+                int d = direction(p.x, p.y);
+                p = Point(p.x - Moves::kDx[d], p.y - Moves::kDy[d]);
+            }
+            result.path.push_back(start);
+            std::reverse(result.path.begin(), result.path.end());
+            return result;
+        }
+
+    private:
+        static constexpr int kBlockShift = 6;
+        static constexpr int kBlock = 1 << kBlockShift;
+
+        struct Block {
+            int g[kBlock * kBlock];
+            std::uint8_t from[kBlock * kBlock];
+        };
+
+        std::size_t index(int x, int y) const { return std::size_t(y >> kBlockShift) * blocksX_ + (x >> kBlockShift); }
+        static int offset(int x, int y) { return (y & (kBlock - 1)) << kBlockShift | (x & (kBlock - 1)); }
+        const Block* find(int x, int y) const { return blocks_[index(x, y)].get(); }
+
+        int width_, blocksX_;
+        std::vector<std::unique_ptr<Block>> blocks_;
+        std::size_t allocated_ = 0;
+    };
+
+    struct Entry {
+        int f, g;
+        std::int64_t lean;  // twice the area between the node and the start-goal line
+        std::int64_t id;
+
+        // Ties on f go to the larger g, the deeper node, then to the node
+        // nearer the straight line. Otherwise the dive hugs one edge of the
+        // band of equally short paths until it is cornered against the goal's
+        // row or column, and on a large 4-way map backing out of there costs
+        // millions of expansions.
+        bool operator>(const Entry& other) const {
+            if (f != other.f) return f > other.f;
+            if (g != other.g) return g < other.g;
+            if (lean != other.lean) return lean > other.lean;
+            return id > other.id;
+        }
+    };
+
+    // Without a component index a walled-in goal would flood the map, so at
+    // least the trivial case of a goal on a wall is refused up front.
+    static bool endpointsValid(TiledGrid& grid, Point start, Point end) {
+        return grid.inBounds(start.x, start.y) && grid.inBounds(end.x, end.y) && !grid.isWall(start.x, start.y) &&
+            !grid.isWall(end.x, end.y);
+    }
+
+    // Calls fn(x, y, direction, unit) for every neighbour Moves allows, with
+    // the same corner rule as Neighbours: a diagonal needs both orthogonal
+    // cells open, or one of them when the policy cuts corners.
+    template <class Moves, class Fn>
+    static void forEachNeighbour(TiledGrid& grid, int x, int y, Fn&& fn) {
+        for (int d = 0; d < Moves::kDirections; ++d) {
+            int dx = Moves::kDx[d], dy = Moves::kDy[d];
+            int nx = x + dx, ny = y + dy;
+            if (!grid.inBounds(nx, ny) || grid.isWall(nx, ny)) continue;
+            if (dx != 0 && dy != 0) {
+                bool openX = !grid.isWall(nx, y), openY = !grid.isWall(x, ny);
+                if (cutsCorners<Moves>() ? (!openX && !openY) : (!openX || !openY)) continue;
+                fn(nx, ny, d, Moves::kDiagonal);
+            }
+            else {
+                fn(nx, ny, d, Moves::kStraight);
+            }
+        }
+    }
+
+    template <class Moves>
+    static constexpr bool cutsCorners() {
+        if constexpr (Moves::kDirections == 8) return Moves::kCutCorners;
+        else return false;
+    }
+
+    template <class Moves, class Heuristic>
+    static TiledSearchResult bestFirst(TiledGrid& grid, Point start, Point end, std::size_t maxStateBytes) {
+        static_assert(!(std::is_same<Heuristic, ManhattanHeuristic>::value && Moves::kDirections == 8),
+            "Manhattan distance overestimates diagonal moves");
+        TiledSearchResult result;
+        TileCacheStats before = grid.cacheStats();
+        if (!endpointsValid(grid, start, end)) return result;
+        State state(grid);
+        auto h = [&](int x, int y) { return Heuristic::template estimate<Moves>(std::abs(x - end.x), std::abs(y - end.y)); };
+        auto lean = [&](int x, int y) {
+            return std::llabs(std::int64_t(x - end.x) * (start.y - end.y) - std::int64_t(y - end.y) * (start.x - end.x));
+        };
+
+        std::vector<Entry> open;
+        std::size_t peakOpen = 1;
+        std::uint64_t expanded = 0;
+        state.reach(start.x, start.y, 0, kStart);
+        open.push_back({ h(start.x, start.y), 0, 0, state.id(start.x, start.y) });
+
+        while (!open.empty()) {
+            std::pop_heap(open.begin(), open.end(), std::greater<Entry>());
+            Entry entry = open.back();
+            open.pop_back();
+            int x = state.x(entry.id), y = state.y(entry.id);
+            if (entry.g > state.g(x, y)) continue;
+            if (x == end.x && y == end.y) {
+                result = state.template trace<Moves>(start, end);
+                break;
+            }
+            ++expanded;
+
+            forEachNeighbour<Moves>(grid, x, y, [&](int nx, int ny, int d, int unit) {
+                int tentative = entry.g + unit * grid.cost(nx, ny);
+                if (tentative >= state.g(nx, ny)) return;
+                state.reach(nx, ny, tentative, static_cast<std::uint8_t>(d));
+                open.push_back({ tentative + h(nx, ny), tentative, lean(nx, ny), state.id(nx, ny) });
+                std::push_heap(open.begin(), open.end(), std::greater<Entry>());
+                });
+            peakOpen = std::max(peakOpen, open.size());
+            if (overBudget(state, peakOpen * sizeof(Entry), maxStateBytes, result)) break;
+        }
+        finish(grid, before, state, expanded, peakOpen * sizeof(Entry), result);
+        return result;
+    }
+
+    static bool overBudget(const State& state, std::size_t openBytes, std::size_t maxStateBytes, TiledSearchResult& result) {
+        if (maxStateBytes == 0 || state.bytes() + openBytes <= maxStateBytes) return false;
+        result.truncated = true;
+        return true;
+    }
+
+    static void finish(const TiledGrid& grid, const TileCacheStats& before, const State& state, std::uint64_t expanded,
+        std::size_t openBytes, TiledSearchResult& result) {
+        result.expanded = expanded;
+        const TileCacheStats& after = grid.cacheStats();
+        result.cache.lookups = after.lookups - before.lookups;
+        result.cache.hits = after.hits - before.hits;
+        result.cache.faults = after.faults - before.faults;
+        result.cache.evictions = after.evictions - before.evictions;
+        result.cache.prefetches = after.prefetches - before.prefetches;
+        result.stateBytes = state.bytes() + openBytes;
+    }
+};
+
+} // namespace Pathfinding
@@ -0,0 +1,337 @@
+#pragma once
+
+#include "Grid.hpp"
+#include "SearchObserver.hpp"
+#include "SearchResult.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+namespace Pathfinding {
+
+// Breadth-first search that expands a whole layer at a time on 64-bit row
+// bitsets. For frontier F, the next layer is
+//
+//     (F | F << 1 | F >> 1 | F above | F below) & open & ~reached
+//
+// evaluated a word at a time, or 4/8 words at a time with AVX2/AVX-512 when
+// the compiler targets them.
+//
+// The frontier is a bitset of the cells reached in the last step. Each
+// reached cell also stores its layer modulo 3 in two bitplanes (code 1..3,
+// 0 = unreached). Neighbouring reached cells differ by at most one layer, so
+// the planes are enough to walk back from the goal: take the neighbour whose
+// code belongs to the previous layer. With the open mask that is four bits per
+// cell in total, against roughly nine bytes for the queue-based BFS. Distances
+// match BFS exactly.
+class WavefrontBFS {
+public:
+    template <class Observer>
+    static SearchResult search(const Grid& grid, int start, int end, Observer& observer) {
+        Wavefront wave(grid, start);
+        Point goal = grid.point(end);
+
+        for (int layer = 0; !wave.reached(goal.x, goal.y); ++layer) {
+            if constexpr (Observer::enabled) wave.forEachFrontierCell([&](int index) { observer.onExpand(index); });
+            bool grew = wave.step(layer, [&](int index) {
+                if constexpr (Observer::enabled) observer.onVisit(index);
+                });
+            if (!grew) return {};
+        }
+        return wave.backtrack(start, end, observer);
+    }
+
+    // Steps from start to every cell, -1 where unreachable.
+    static std::vector<int> distanceField(const Grid& grid, int start) {
+        std::vector<int> distance(grid.cellCount(), -1);
+        Wavefront wave(grid, start);
+        distance[start] = 0;
+        for (int layer = 0; wave.step(layer, [&](int index) { distance[index] = layer + 1; }); ++layer) {}
+        return distance;
+    }
+
+private:
+    class Wavefront {
+    public:
+        Wavefront(const Grid& grid, int start)
+            : grid_(grid), words_(grid.wordsPerRow()), stride_(grid.wordsPerRow() + 2),
+              summaryWords_((grid.wordsPerRow() + 63) / 64), summaryStride_(summaryWords_ + 2), height_(grid.height()) {
+            // Every bitset has a zero guard word on each side of a row and a
+            // zero guard row above and below, so shifts and vertical
+            // neighbours need no bounds checks.
+            std::size_t size = static_cast<std::size_t>(stride_) * (height_ + 2);
+            open_.assign(size, 0);
+            plane0_.assign(size, 0);
+            plane1_.assign(size, 0);
+            frontier_.assign(size, 0);
+            fresh_.assign(stride_, 0);
+            std::size_t summarySize = static_cast<std::size_t>(summaryStride_) * (height_ + 2);
+            active_.assign(summarySize, 0);
+            nextActive_.assign(summarySize, 0);
+            touch_.assign(summarySize, 0);
+            nextTouch_.assign(summarySize, 0);
+
+            int tail = grid.width() - (words_ - 1) * 64;
+            std::uint64_t lastMask = tail == 64 ? ~std::uint64_t(0) : (std::uint64_t(1) << tail) - 1;
+            for (int y = 0; y < height_; ++y) {
+                const std::uint64_t* walls = grid.row(y);
+                std::uint64_t* open = word(open_, y, 0);
+                for (int k = 0; k < words_; ++k) open[k] = ~walls[k];
+                open[words_ - 1] &= lastMask;
+            }
+
+            Point p = grid.point(start);
+            std::uint64_t bit = std::uint64_t(1) << (p.x & 63);
+            *word(plane0_, p.y, p.x >> 6) = bit; // layer 0 has code 1
+            *word(frontier_, p.y, p.x >> 6) = bit;
+            frontierWords_.push_back({ p.y, p.x >> 6, bit });
+            markFrontier(active_, touch_, p.y, p.x >> 6, bit);
+            rows_.push_back(p.y);
+        }
+
+        bool reached(int x, int y) const { return code(x, y) != 0; }
+
+        template <class Fn>
+        void forEachFrontierCell(Fn&& fn) const {
+            for (const FrontierWord& w : frontierWords_) forEachBit(w.bits, w.y, w.k, fn);
+        }
+
+        // Expands the frontier (at distance layer) by one step and calls
+        // onNew for every newly reached cell. Returns false once nothing new
+        // was reached.
+        template <class Fn>
+        bool step(int layer, Fn&& onNew) {
+            Codes codes(layer);
+
+            // Rows the next layer can reach are the frontier rows and their
+            // neighbours; rows_ is sorted, so they come out sorted too.
+            nextRows_.clear();
+            int lastRow = -1;
+            for (int r : rows_) {
+                for (int y = std::max(r - 1, lastRow + 1); y <= std::min(r + 1, height_ - 1); ++y) {
+                    if (expandCandidates(y, codes, onNew)) nextRows_.push_back(y);
+                    lastRow = y;
+                }
+            }
+
+            for (int y : rows_) {
+                std::fill_n(summary(active_, y, 0), summaryWords_, 0);
+                std::fill_n(summary(touch_, y, 0), summaryWords_, 0);
+            }
+            // The new cells become the frontier only now, so no row of this
+            // step saw them as frontier.
+            for (const FrontierWord& w : frontierWords_) *word(frontier_, w.y, w.k) = 0;
+            for (const FrontierWord& w : nextWords_) *word(frontier_, w.y, w.k) = w.bits;
+            frontierWords_.swap(nextWords_);
+            nextWords_.clear();
+            active_.swap(nextActive_);
+            touch_.swap(nextTouch_);
+            rows_.swap(nextRows_);
+            return !rows_.empty();
+        }
+
+        template <class Observer>
+        SearchResult backtrack(int start, int end, Observer& observer) const {
+            SearchResult result;
+            result.found = true;
+
+            int w = grid_.width();
+            for (int current = end; current != start;) {
+                result.path.push_back(current);
+                observer.onPath(current);
+
+                int x = current % w, y = current / w;
+                int previous = (code(x, y) + 1) % 3 + 1; // code of the layer before
+                if (x > 0 && code(x - 1, y) == previous) current -= 1;
+                else if (y > 0 && code(x, y - 1) == previous) current -= w;
+                else if (y + 1 < height_ && code(x, y + 1) == previous) current += w;
+                else current += 1;
+            }
+            result.path.push_back(start);
+            std::reverse(result.path.begin(), result.path.end());
+            return result;
+        }
+
+    private:
+        // Plane masks that write the next layer's code.
+        struct Codes {
+            std::uint64_t set0, set1;
+
+            explicit Codes(int layer) {
+                int next = (layer + 1) % 3 + 1;
+                set0 = (next & 1) ? ~std::uint64_t(0) : 0;
+                set1 = (next & 2) ? ~std::uint64_t(0) : 0;
+            }
+        };
+
+        // One non-empty word of a frontier.
+        struct FrontierWord {
+            int y, k;
+            std::uint64_t bits;
+        };
+
+        std::uint64_t* word(std::vector<std::uint64_t>& bits, int y, int k) {
+            return bits.data() + static_cast<std::size_t>(y + 1) * stride_ + 1 + k;
+        }
+        const std::uint64_t* word(const std::vector<std::uint64_t>& bits, int y, int k) const {
+            return bits.data() + static_cast<std::size_t>(y + 1) * stride_ + 1 + k;
+        }
+
+        std::uint64_t* summary(std::vector<std::uint64_t>& bits, int y, int m) {
+            return bits.data() + static_cast<std::size_t>(y + 1) * summaryStride_ + 1 + m;
+        }
+        const std::uint64_t* summary(const std::vector<std::uint64_t>& bits, int y, int m) const {
+            return bits.data() + static_cast<std::size_t>(y + 1) * summaryStride_ + 1 + m;
+        }
+
+        int code(int x, int y) const {
+            int k = x >> 6, bit = x & 63;
+            return static_cast<int>((*word(plane0_, y, k) >> bit) & 1) | static_cast<int>(((*word(plane1_, y, k) >> bit) & 1) << 1);
+        }
+
+        // Records that word k of row y holds frontier cells `bits`: the word
+        // is active, and it touches its neighbour word when a cell sits on the
+        // shared edge.
+        void markFrontier(std::vector<std::uint64_t>& active, std::vector<std::uint64_t>& touch, int y, int k, std::uint64_t bits) {
+            std::uint64_t bit = std::uint64_t(1) << (k & 63);
+            *summary(active, y, k >> 6) |= bit;
+            *summary(touch, y, k >> 6) |= bit;
+            if ((bits & 1) && k > 0) *summary(touch, y, (k - 1) >> 6) |= std::uint64_t(1) << ((k - 1) & 63);
+            if ((bits >> 63) && k + 1 < words_) *summary(touch, y, (k + 1) >> 6) |= std::uint64_t(1) << ((k + 1) & 63);
+        }
+
+        // Each row keeps two summary bitmaps with one bit per frontier word:
+        // active marks non-empty words and touch adds the neighbouring word
+        // when the frontier reaches the shared edge. Word k of row y can only
+        // gain cells if it is touched in row y or active in row y - 1 or
+        // y + 1, so finding candidates takes a few ORs and the work follows
+        // the frontier, even where it crosses a row twice as a diamond-shaped
+        // wave does. Runs of consecutive candidates are expanded together so
+        // they can use the vector loop.
+        template <class Fn>
+        bool expandCandidates(int y, const Codes& codes, Fn&& onNew) {
+            const std::uint64_t* touched = summary(touch_, y, 0);
+            const std::uint64_t* up = summary(active_, y - 1, 0);
+            const std::uint64_t* down = summary(active_, y + 1, 0);
+            const std::uint64_t* fresh = fresh_.data() + 1;
+
+            bool any = false;
+            for (int m = 0; m < summaryWords_; ++m) {
+                std::uint64_t candidates = touched[m] | up[m] | down[m];
+                while (candidates) {
+                    int lo = lowestBit(candidates);
+                    std::uint64_t rest = ~(candidates >> lo);
+                    int length = rest ? lowestBit(rest) : 64;
+                    int k0 = m * 64 + lo;
+                    expandRow(y, k0, k0 + length - 1, codes);
+
+                    for (int k = k0; k < k0 + length; ++k) {
+                        if (!fresh[k]) continue;
+                        any = true;
+                        nextWords_.push_back({ y, k, fresh[k] });
+                        markFrontier(nextActive_, nextTouch_, y, k, fresh[k]);
+                        forEachBit(fresh[k], y, k, onNew);
+                    }
+                    candidates &= length == 64 ? 0 : ~(((std::uint64_t(1) << length) - 1) << lo);
+                }
+            }
+            return any;
+        }
+
+        // Computes the new cells of words lo..hi of row y into fresh_ and
+        // stamps them with the next layer's code.
+        void expandRow(int y, int lo, int hi, const Codes& codes) {
+            const std::uint64_t* open = word(open_, y, 0);
+            std::uint64_t* p0 = word(plane0_, y, 0);
+            std::uint64_t* p1 = word(plane1_, y, 0);
+            const std::uint64_t* f = word(frontier_, y, 0);
+            const std::uint64_t* up = f - stride_;
+            const std::uint64_t* down = f + stride_;
+            std::uint64_t* fresh = fresh_.data() + 1;
+
+            int k = lo;
+#if defined(__AVX512F__)
+            const __m512i set0 = _mm512_set1_epi64(static_cast<long long>(codes.set0));
+            const __m512i set1 = _mm512_set1_epi64(static_cast<long long>(codes.set1));
+            for (; k + 7 <= hi; k += 8) {
+                __m512i centre = _mm512_loadu_si512(f + k);
+                __m512i spread = _mm512_or_si512(
+                    _mm512_or_si512(_mm512_slli_epi64(centre, 1), _mm512_srli_epi64(centre, 1)),
+                    _mm512_or_si512(_mm512_srli_epi64(_mm512_loadu_si512(f + k - 1), 63), _mm512_slli_epi64(_mm512_loadu_si512(f + k + 1), 63)));
+                spread = _mm512_or_si512(spread, _mm512_or_si512(_mm512_loadu_si512(up + k), _mm512_loadu_si512(down + k)));
+                __m512i a = _mm512_loadu_si512(p0 + k), b = _mm512_loadu_si512(p1 + k);
+                __m512i found = _mm512_andnot_si512(_mm512_or_si512(a, b), _mm512_and_si512(spread, _mm512_loadu_si512(open + k)));
+                _mm512_storeu_si512(fresh + k, found);
+                _mm512_storeu_si512(p0 + k, _mm512_or_si512(a, _mm512_and_si512(found, set0)));
+                _mm512_storeu_si512(p1 + k, _mm512_or_si512(b, _mm512_and_si512(found, set1)));
+            }
+#elif defined(__AVX2__)
+            const __m256i set0 = _mm256_set1_epi64x(static_cast<long long>(codes.set0));
+            const __m256i set1 = _mm256_set1_epi64x(static_cast<long long>(codes.set1));
+            auto load = [](const std::uint64_t* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); };
+            auto store = [](std::uint64_t* p, __m256i v) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); };
+            for (; k + 3 <= hi; k += 4) {
+                __m256i centre = load(f + k);
+                __m256i spread = _mm256_or_si256(
+                    _mm256_or_si256(_mm256_slli_epi64(centre, 1), _mm256_srli_epi64(centre, 1)),
+                    _mm256_or_si256(_mm256_srli_epi64(load(f + k - 1), 63), _mm256_slli_epi64(load(f + k + 1), 63)));
+                spread = _mm256_or_si256(spread, _mm256_or_si256(load(up + k), load(down + k)));
+                __m256i a = load(p0 + k), b = load(p1 + k);
+                __m256i found = _mm256_andnot_si256(_mm256_or_si256(a, b), _mm256_and_si256(spread, load(open + k)));
+                store(fresh + k, found);
+                store(p0 + k, _mm256_or_si256(a, _mm256_and_si256(found, set0)));
+                store(p1 + k, _mm256_or_si256(b, _mm256_and_si256(found, set1)));
+            }
+#endif
+            for (; k <= hi; ++k) {
+                std::uint64_t centre = f[k];
+                std::uint64_t spread = (centre << 1) | (centre >> 1) | (f[k - 1] >> 63) | (f[k + 1] << 63) | up[k] | down[k];
+                std::uint64_t found = spread & open[k] & ~(p0[k] | p1[k]);
+                fresh[k] = found;
+                p0[k] |= found & codes.set0;
+                p1[k] |= found & codes.set1;
+            }
+        }
+
+        template <class Fn>
+        void forEachBit(std::uint64_t bits, int y, int k, Fn&& fn) const {
+            int base = y * grid_.width() + k * 64;
+            while (bits) {
+                fn(base + lowestBit(bits));
+                bits &= bits - 1;
+            }
+        }
+
+        static int lowestBit(std::uint64_t v) {
+#if defined(_MSC_VER)
+            unsigned long bit;
+            _BitScanForward64(&bit, v);
+            return static_cast<int>(bit);
+#else
+            return __builtin_ctzll(v);
+#endif
+        }
+
+        const Grid& grid_;
+        int words_, stride_;
+        int summaryWords_, summaryStride_;
+        int height_;
+        std::vector<std::uint64_t> open_, plane0_, plane1_;
+        std::vector<std::uint64_t> frontier_;             // cells reached in the last step
+        std::vector<FrontierWord> frontierWords_, nextWords_; // non-empty words of frontier_ and of the next one
+        std::vector<std::uint64_t> fresh_;               // new cells of the row being expanded
+        std::vector<std::uint64_t> active_, nextActive_; // one bit per non-empty frontier word
+        std::vector<std::uint64_t> touch_, nextTouch_;   // words the frontier can spread into along its row
+        std::vector<int> rows_, nextRows_;               // rows with a non-empty frontier, ascending
+    };
+};
+
+} // namespace Pathfinding
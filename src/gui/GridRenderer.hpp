@@ -0,0 +1,83 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Draws the grid as a single texture with one texel per cell. Cells are recoloured
+// in a CPU-side pixel buffer and only the band of rows touched since the last
+// frame is uploaded, so a frame costs one texture update and one draw call for
+// the cells however large the grid is. Grid lines are one extra vertex array and
+// are skipped once cells get too small for them to be readable.
+class GridRenderer {
+public:
+    void resize(int width, int height, float cellSize) {
+        this->width = width;
+        this->height = height;
+        this->cellSize = cellSize;
+
+        pixels.assign(static_cast<std::size_t>(width) * height * 4, 255);
+        texture.create(width, height);
+        texture.setSmooth(false);
+        sprite.setTexture(texture, true);
+        sprite.setScale(cellSize, cellSize);
+        dirtyMin = 0;
+        dirtyMax = height - 1;
+
+        lines.clear();
+        lines.setPrimitiveType(sf::Lines);
+        if (cellSize >= MIN_LINE_CELL_SIZE) {
+            const sf::Color lineColor(50, 50, 50);
+            float right = width * cellSize, bottom = height * cellSize;
+            for (int x = 0; x <= width; ++x) {
+                lines.append(sf::Vertex(sf::Vector2f(x * cellSize, 0), lineColor));
+                lines.append(sf::Vertex(sf::Vector2f(x * cellSize, bottom), lineColor));
+            }
+            for (int y = 0; y <= height; ++y) {
+                lines.append(sf::Vertex(sf::Vector2f(0, y * cellSize), lineColor));
+                lines.append(sf::Vertex(sf::Vector2f(right, y * cellSize), lineColor));
+            }
+        }
+    }
+
+    void setCell(int index, const sf::Color& color) {
+        sf::Uint8* px = &pixels[static_cast<std::size_t>(index) * 4];
+        if (px[0] == color.r && px[1] == color.g && px[2] == color.b) return;
+
+        px[0] = color.r;
+        px[1] = color.g;
+        px[2] = color.b;
+        int y = index / width;
+        dirtyMin = std::min(dirtyMin, y);
+        dirtyMax = std::max(dirtyMax, y);
+    }
+
+    // states positions the grid, e.g. one pane of a side-by-side replay.
+    void draw(sf::RenderTarget& target, const sf::RenderStates& states = sf::RenderStates::Default) {
+        if (dirtyMin <= dirtyMax) {
+            texture.update(&pixels[static_cast<std::size_t>(dirtyMin) * width * 4],
+                width, dirtyMax - dirtyMin + 1, 0, dirtyMin);
+            dirtyMin = height;
+            dirtyMax = -1;
+        }
+        target.draw(sprite, states);
+        if (lines.getVertexCount() > 0) target.draw(lines, states);
+    }
+
+    float getCellSize() const { return cellSize; }
+    sf::Vector2f getSize() const { return sf::Vector2f(width * cellSize, height * cellSize); }
+
+private:
+    static constexpr float MIN_LINE_CELL_SIZE = 4.0f;
+
+    int width = 0, height = 0;
+    float cellSize = 1.0f;
+    std::vector<sf::Uint8> pixels; // RGBA, one texel per cell
+    int dirtyMin = 0, dirtyMax = -1; // inclusive row range changed since the last upload
+    sf::Texture texture;
+    sf::Sprite sprite;
+    sf::VertexArray lines;
+};
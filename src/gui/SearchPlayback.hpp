@@ -0,0 +1,119 @@
+#pragma once
+
+#include "../core/SearchEvent.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <functional>
+#include <thread>
+#include <vector>
+
+// Runs a search job on a worker thread and plays its events back on the render
+// thread. Every frame drains the whole ring into a local log, so the worker is
+// never throttled by playback; pause, single-step, speed changes and "run to
+// completion" only move the playback cursor over that log.
+class SearchPlayback {
+public:
+    using Job = std::function<void(Pathfinding::QueueObserver&)>;
+
+    SearchPlayback() : queue(QUEUE_CAPACITY) {}
+    ~SearchPlayback() { cancel(); }
+
+    void start(Job job) {
+        cancel();
+        log.clear();
+        cursor = 0;
+        credit = 0.0;
+        paused = false;
+        toEnd = false;
+        workerDone = false;
+        cancelled.store(false, std::memory_order_relaxed);
+        finished.store(false, std::memory_order_relaxed);
+
+        worker = std::thread([this, job = std::move(job)]() {
+            Pathfinding::QueueObserver observer(queue, cancelled);
+            job(observer);
+            finished.store(true, std::memory_order_release);
+            });
+    }
+
+    // Stops listening to the worker and waits for it to return.
+    void cancel() {
+        if (!worker.joinable()) return;
+        cancelled.store(true, std::memory_order_relaxed);
+        while (!finished.load(std::memory_order_acquire)) {
+            queue.drain([](const Pathfinding::SearchEvent&) {});
+            std::this_thread::yield();
+        }
+        worker.join();
+        queue.drain([](const Pathfinding::SearchEvent&) {});
+    }
+
+    // Pulls new events from the worker and applies as many as this frame's
+    // budget allows (eventsPerFrame scaled by the playback speed).
+    template <class Fn>
+    void update(int eventsPerFrame, Fn&& apply) {
+        pull();
+        if (toEnd) {
+            applyUpTo(log.size(), apply);
+            return;
+        }
+        if (paused) return;
+
+        credit += eventsPerFrame * std::pow(2.0, speedExponent);
+        std::size_t count = static_cast<std::size_t>(credit);
+        credit -= count;
+        applyUpTo(cursor + count, apply);
+    }
+
+    template <class Fn>
+    void step(Fn&& apply) {
+        pull();
+        applyUpTo(cursor + 1, apply);
+    }
+
+    // True once the worker has returned and every event has been played.
+    bool isDone() const { return workerDone && cursor == log.size(); }
+
+    void togglePause() { paused = !paused; }
+    void finish() { toEnd = true; }
+    void faster() { speedExponent = std::min(speedExponent + 1, MAX_SPEED_EXPONENT); }
+    void slower() { speedExponent = std::max(speedExponent - 1, MIN_SPEED_EXPONENT); }
+
+    bool isPaused() const { return paused; }
+    double speed() const { return std::pow(2.0, speedExponent); }
+
+private:
+    static constexpr std::size_t QUEUE_CAPACITY = 1 << 16;
+    static constexpr int MIN_SPEED_EXPONENT = -6;
+    static constexpr int MAX_SPEED_EXPONENT = 10;
+
+    void pull() {
+        // Read the flag before draining: once it is set, every event is already in the ring.
+        bool done = finished.load(std::memory_order_acquire);
+        queue.drain([this](const Pathfinding::SearchEvent& event) { log.push_back(event); });
+        if (done && worker.joinable()) worker.join();
+        workerDone = done;
+    }
+
+    template <class Fn>
+    void applyUpTo(std::size_t end, Fn& apply) {
+        end = std::min(end, log.size());
+        for (; cursor < end; ++cursor) apply(log[cursor]);
+    }
+
+    Pathfinding::SpscQueue<Pathfinding::SearchEvent> queue;
+    std::vector<Pathfinding::SearchEvent> log;
+    std::size_t cursor = 0;
+    double credit = 0.0;
+    int speedExponent = 0;
+    bool paused = false;
+    bool toEnd = false;
+    bool workerDone = false;
+
+    std::thread worker;
+    std::atomic<bool> cancelled{ false };
+    std::atomic<bool> finished{ false };
+};
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "../core/SearchTrace.hpp"
+#include "GridRenderer.hpp"
+
+#include <SFML/Graphics.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Plays a recorded trace into a grid pane of its own. The trace stays memory
+// mapped; the pane keeps only the step at which each cell was first visited
+// and first put on the path. Moving the playhead either way decodes just the
+// events between the old and new step and repaints the cells they touch, so
+// scrubbing costs the distance moved and nothing else.
+class TraceReplay {
+public:
+    struct Palette {
+        sf::Color empty, wall, start, end, visited, path;
+    };
+
+    // Fits the grid into maxWidth x maxHeight. Throws if the trace cannot be read.
+    TraceReplay(const std::string& path, const Palette& palette, float maxWidth, float maxHeight)
+        : name(path), trace(path), palette(palette) {
+        if (trace.size() >= NEVER) throw std::runtime_error("Trace too long to replay: " + path);
+
+        float cellSize = std::min(maxWidth / trace.width(), maxHeight / trace.height());
+        if (cellSize >= 1.0f) cellSize = std::floor(cellSize);
+        renderer.resize(trace.width(), trace.height(), cellSize);
+
+        visitedAt.assign(trace.cellCount(), NEVER);
+        pathAt.assign(trace.cellCount(), NEVER);
+        for (int cell = 0; cell < trace.cellCount(); ++cell) repaint(cell);
+    }
+
+    TraceReplay(const TraceReplay&) = delete;
+    TraceReplay& operator=(const TraceReplay&) = delete;
+
+    // Shows the grid as it was after the first step events.
+    void seek(std::uint64_t step) {
+        step = std::min(step, trace.size());
+        Pathfinding::SearchEvent event;
+        if (step > shown) {
+            Pathfinding::TraceReader::Cursor cursor = trace.at(shown);
+            for (std::uint64_t i = shown; i < step && cursor.next(event); ++i) {
+                std::uint32_t& first = firstStep(event);
+                if (first != NEVER) continue;
+                first = static_cast<std::uint32_t>(i);
+                repaint(event.index);
+            }
+        }
+        else if (step < shown) {
+            // Every event before shown has been applied, so a cell's recorded
+            // step is its earliest and it only changes if that lies past step.
+            Pathfinding::TraceReader::Cursor cursor = trace.at(step);
+            for (std::uint64_t i = step; i < shown && cursor.next(event); ++i) {
+                std::uint32_t& first = firstStep(event);
+                if (first == NEVER || first < step) continue;
+                first = NEVER;
+                repaint(event.index);
+            }
+        }
+        shown = step;
+    }
+
+    void draw(sf::RenderTarget& target, sf::Vector2f position) {
+        sf::RenderStates states;
+        states.transform.translate(position);
+        renderer.draw(target, states);
+    }
+
+    const std::string& getName() const { return name; }
+    std::uint64_t length() const { return trace.size(); }
+    std::uint64_t position() const { return shown; }
+    sf::Vector2f getSize() const { return renderer.getSize(); }
+
+private:
+    static constexpr std::uint32_t NEVER = 0xffffffffu;
+
+    std::uint32_t& firstStep(const Pathfinding::SearchEvent& event) {
+        return event.type == Pathfinding::SearchEvent::Type::Path ? pathAt[event.index] : visitedAt[event.index];
+    }
+
+    void repaint(int cell) {
+        const sf::Color* color = &palette.empty;
+        if (cell == trace.start()) color = &palette.start;
+        else if (cell == trace.goal()) color = &palette.end;
+        else if (pathAt[cell] != NEVER) color = &palette.path;
+        else if (visitedAt[cell] != NEVER) color = &palette.visited;
+        else if (trace.isWall(cell)) color = &palette.wall;
+        renderer.setCell(cell, *color);
+    }
+
+    std::string name;
+    Pathfinding::TraceReader trace;
+    Palette palette;
+    GridRenderer renderer;
+    std::vector<std::uint32_t> visitedAt, pathAt; // step of the first such event, or NEVER
+    std::uint64_t shown = 0;
+};
@@ -1,600 +1,731 @@
-#include <SFML/Graphics.hpp>
-// #include<Windows.h>
-#include <vector>
-#include <queue>
-#include <stack>
-#include <chrono>
-#include <random>
-#include <cmath>
-#include <sstream>
-#include <iomanip>
-#include <iostream>
-#include <limits>
-using namespace std;
-using namespace chrono;
-
-// Constants
-const int WINDOW_WIDTH = 1200;
-const int WINDOW_HEIGHT = 800;
-const int GRID_SIZE = 40;
-const int CELL_SIZE = min(WINDOW_HEIGHT, WINDOW_WIDTH) / GRID_SIZE;
-const int UI_WIDTH = 300;
-const int BTN_HEIGHT = 40;
-const int BTN_SPACING = 10;
-#ifndef INFINITY
-const float INFINITY = numeric_limits<float>::max();
-#endif
-enum class CellType { Empty, Wall, Start, End, Path, Visited };
-enum class Algorithm { BFS, DFS, AStar, Dijkstra, Greedy };
-enum class State { IDLE, VISUALIZING };
-
-
-struct Cell {
-    sf::RectangleShape rect;
-    CellType type = CellType::Empty;
-    int x, y;
-
-    Cell(int x, int y) : x(x), y(y) {
-        rect.setSize(sf::Vector2f(CELL_SIZE - 1, CELL_SIZE - 1));
-        rect.setPosition(x * CELL_SIZE, y * CELL_SIZE);
-        rect.setFillColor(sf::Color::White);
-    }
-};
-
-vector<vector<Cell>> grid(GRID_SIZE, vector<Cell>(GRID_SIZE, Cell(0, 0)));
-sf::Font font;
-pair<int, int> startPos(-1, -1), endPos(-1, -1);
-int visualizationDelay = 10;
-
-Algorithm currentAlgorithm = Algorithm::BFS;
-string statusMessage = "Ready";
-double lastBenchmark = 0.0;
-bool pathFound = false;
-State currentState = State::IDLE;
-
-namespace Colors {
-    const sf::Color Background(40, 40, 40);
-    const sf::Color Wall(30, 30, 30);
-    const sf::Color Start(0, 200, 0);
-    const sf::Color End(200, 0, 0);
-    const sf::Color Path(255, 255, 100);
-    const sf::Color Visited(100, 200, 255);
-    const sf::Color Button(70, 70, 70);
-    const sf::Color ButtonHover(100, 100, 100);
-    const sf::Color Text(255, 255, 255);
-}
-
-
-class MazeGenerator {
-public:
-    static void generateRandomWalls(double probability) {
-        cout << "Generating random walls..." << endl; // Debug statement
-
-        static mt19937 rng(chrono::system_clock::now().time_since_epoch().count());
-        bernoulli_distribution dist(probability);
-
-        for (auto& row : grid) {
-            for (auto& cell : row) {
-                if (cell.type != CellType::Start && cell.type != CellType::End) {
-                    cell.type = dist(rng) ? CellType::Wall : CellType::Empty;
-                }
-            }
-        }
-
-        cout << "Random walls generated!" << endl; // Debug statement
-    }
-};
-void drawGrid(sf::RenderWindow& window) {
-    cout << "Drawing grid..." << endl; // Debug statement
-
-    for (auto& row : grid) {
-        for (auto& cell : row) {
-            switch (cell.type) {
-            case CellType::Wall: cell.rect.setFillColor(Colors::Wall); break;
-            case CellType::Start: cell.rect.setFillColor(Colors::Start); break;
-            case CellType::End: cell.rect.setFillColor(Colors::End); break;
-            case CellType::Path: cell.rect.setFillColor(Colors::Path); break;
-            case CellType::Visited: cell.rect.setFillColor(Colors::Visited); break;
-            default: cell.rect.setFillColor(sf::Color::White);
-            }
-            window.draw(cell.rect);
-        }
-    }
-
-    // Draw grid lines
-    sf::RectangleShape line(sf::Vector2f(1, WINDOW_HEIGHT));
-    line.setFillColor(sf::Color(50, 50, 50));
-    for (int x = 0; x <= GRID_SIZE; ++x) {
-        line.setPosition(x * CELL_SIZE, 0);
-        window.draw(line);
-    }
-
-    line.setSize(sf::Vector2f(WINDOW_WIDTH, 1));
-    for (int y = 0; y <= GRID_SIZE; ++y) {
-        line.setPosition(0, y * CELL_SIZE);
-        window.draw(line);
-    }
-}
-
-class Pathfinder {
-public:
-    static bool findPath(Algorithm algo, sf::RenderWindow& window, double& duration) {
-        auto start = high_resolution_clock::now();
-        pathFound = false;
-
-        switch (algo) {
-        case Algorithm::BFS: pathFound = BFS(window); break;
-        case Algorithm::DFS: pathFound = DFS(window); break;
-        case Algorithm::AStar: pathFound = aStar(window); break;
-        case Algorithm::Dijkstra: pathFound = dijkstra(window); break;
-        case Algorithm::Greedy: pathFound = greedy(window); break;
-        }
-
-        duration = duration_cast<milliseconds>(high_resolution_clock::now() - start).count() / 1000.0;
-        lastBenchmark = duration;
-        return pathFound;
-    }
-
-private:
-    struct Node {
-        int x, y;
-        float g, h;
-
-        Node(int x, int y, float g, float h) : x(x), y(y), g(g), h(h) {}
-        bool operator>(const Node& other) const { return (g + h) > (other.g + other.h); }
-    };
-
-    static bool BFS(sf::RenderWindow& window) {
-        queue<pair<int, int>> q;
-        vector<vector<bool>> visited(GRID_SIZE, vector<bool>(GRID_SIZE, false));
-        vector<vector<pair<int, int>>> parent(GRID_SIZE, vector<pair<int, int>>(GRID_SIZE, { -1, -1 }));
-
-        q.push(startPos);
-        visited[startPos.second][startPos.first] = true;
-
-        while (!q.empty()) {
-            auto [x, y] = q.front();
-            q.pop();
-
-            if (x == endPos.first && y == endPos.second) {
-                reconstructPath(parent, window);
-                return true;
-            }
-
-            for (int dx : {-1, 0, 1}) {
-                for (int dy : {-1, 0, 1}) {
-                    if (abs(dx) + abs(dy) != 1) continue;
-
-                    int nx = x + dx, ny = y + dy;
-                    if (nx >= 0 && nx < GRID_SIZE && ny >= 0 && ny < GRID_SIZE &&
-                        !visited[ny][nx] && grid[ny][nx].type != CellType::Wall) {
-                        visited[ny][nx] = true;
-                        parent[ny][nx] = { x, y };
-                        q.push({ nx, ny });
-                        updateVisual(ny, nx, window);
-                    }
-                }
-            }
-        }
-        return false;
-    }
-
-    static bool DFS(sf::RenderWindow& window) {
-        stack<pair<int, int>> s;
-        vector<vector<bool>> visited(GRID_SIZE, vector<bool>(GRID_SIZE, false));
-        vector<vector<pair<int, int>>> parent(GRID_SIZE, vector<pair<int, int>>(GRID_SIZE, { -1, -1 }));
-
-        s.push(startPos);
-        visited[startPos.second][startPos.first] = true;
-
-        while (!s.empty()) {
-            auto [x, y] = s.top();
-            s.pop();
-
-            if (x == endPos.first && y == endPos.second) {
-                reconstructPath(parent, window);
-                return true;
-            }
-
-            for (int dx : {-1, 0, 1}) {
-                for (int dy : {-1, 0, 1}) {
-                    if (abs(dx) + abs(dy) != 1) continue;
-
-                    int nx = x + dx, ny = y + dy;
-                    if (nx >= 0 && nx < GRID_SIZE && ny >= 0 && ny < GRID_SIZE &&
-                        !visited[ny][nx] && grid[ny][nx].type != CellType::Wall) {
-                        visited[ny][nx] = true;
-                        parent[ny][nx] = { x, y };
-                        s.push({ nx, ny });
-                        updateVisual(ny, nx, window);
-                    }
-                }
-            }
-        }
-        return false;
-    }
-
-    static bool dijkstra(sf::RenderWindow& window) {
-        priority_queue<pair<float, pair<int, int>>,
-            vector<pair<float, pair<int, int>>>,
-            greater<>> pq;
-
-        vector<vector<float>> dist(GRID_SIZE, vector<float>(GRID_SIZE, INFINITY));
-        vector<vector<pair<int, int>>> parent(GRID_SIZE, vector<pair<int, int>>(GRID_SIZE, { -1, -1 }));
-
-        dist[startPos.second][startPos.first] = 0;
-        pq.push({ 0, startPos });
-
-        while (!pq.empty()) {
-            auto [currentDist, pos] = pq.top();
-            auto [x, y] = pos;
-            pq.pop();
-
-            if (x == endPos.first && y == endPos.second) {
-                reconstructPath(parent, window);
-                return true;
-            }
-
-            if (currentDist > dist[y][x]) continue;
-
-            for (int dx : {-1, 0, 1}) {
-                for (int dy : {-1, 0, 1}) {
-                    if (abs(dx) + abs(dy) != 1) continue;
-
-                    int nx = x + dx, ny = y + dy;
-                    if (nx >= 0 && nx < GRID_SIZE && ny >= 0 && ny < GRID_SIZE &&
-                        grid[ny][nx].type != CellType::Wall) {
-
-                        float newDist = currentDist + 1;
-                        if (newDist < dist[ny][nx]) {
-                            dist[ny][nx] = newDist;
-                            parent[ny][nx] = { x, y };
-                            pq.push({ newDist, {nx, ny} });
-                            updateVisual(ny, nx, window);
-                        }
-                    }
-                }
-            }
-        }
-        return false;
-    }
-
-    static bool greedy(sf::RenderWindow& window) {
-        auto heuristic = [](int x1, int y1) {
-            return abs(x1 - endPos.first) + abs(y1 - endPos.second);
-            };
-
-        priority_queue<pair<int, pair<int, int>>,
-            vector<pair<int, pair<int, int>>>,
-            greater<>> pq;
-
-        vector<vector<bool>> visited(GRID_SIZE, vector<bool>(GRID_SIZE, false));
-        vector<vector<pair<int, int>>> parent(GRID_SIZE, vector<pair<int, int>>(GRID_SIZE, { -1, -1 }));
-
-        pq.push({ heuristic(startPos.first, startPos.second), startPos });
-        visited[startPos.second][startPos.first] = true;
-
-        while (!pq.empty()) {
-            auto [hVal, pos] = pq.top();
-            auto [x, y] = pos;
-            pq.pop();
-
-            if (x == endPos.first && y == endPos.second) {
-                reconstructPath(parent, window);
-                return true;
-            }
-
-            for (int dx : {-1, 0, 1}) {
-                for (int dy : {-1, 0, 1}) {
-                    if (abs(dx) + abs(dy) != 1) continue;
-
-                    int nx = x + dx, ny = y + dy;
-                    if (nx >= 0 && nx < GRID_SIZE && ny >= 0 && ny < GRID_SIZE &&
-                        !visited[ny][nx] && grid[ny][nx].type != CellType::Wall) {
-                        visited[ny][nx] = true;
-                        parent[ny][nx] = { x, y };
-                        pq.push({ heuristic(nx, ny), {nx, ny} });
-                        updateVisual(ny, nx, window);
-                    }
-                }
-            }
-        }
-        return false;
-    }
-
-    static bool aStar(sf::RenderWindow& window) {
-        priority_queue<Node, vector<Node>, greater<Node>> openSet;
-        vector<vector<float>> gScore(GRID_SIZE, vector<float>(GRID_SIZE, INFINITY));
-        vector<vector<pair<int, int>>> parent(GRID_SIZE, vector<pair<int, int>>(GRID_SIZE, { -1, -1 }));
-
-        auto heuristic = [](int x1, int y1, int x2, int y2) {
-            return abs(x1 - x2) + abs(y1 - y2);
-            };
-
-        gScore[startPos.second][startPos.first] = 0;
-        openSet.push(Node(startPos.first, startPos.second, 0,
-            heuristic(startPos.first, startPos.second, endPos.first, endPos.second)));
-
-        while (!openSet.empty()) {
-            Node current = openSet.top();
-            openSet.pop();
-
-            if (current.x == endPos.first && current.y == endPos.second) {
-                reconstructPath(parent, window);
-                return true;
-            }
-
-            for (int dx : {-1, 0, 1}) {
-                for (int dy : {-1, 0, 1}) {
-                    if (dx == 0 && dy == 0) continue;
-                    if (abs(dx) + abs(dy) == 2) continue;
-
-                    int nx = current.x + dx, ny = current.y + dy;
-                    if (nx < 0 || nx >= GRID_SIZE || ny < 0 || ny >= GRID_SIZE) continue;
-                    if (grid[ny][nx].type == CellType::Wall) continue;
-
-                    float tentativeG = current.g + 1;
-                    if (tentativeG < gScore[ny][nx]) {
-                        parent[ny][nx] = { current.x, current.y };
-                        gScore[ny][nx] = tentativeG;
-                        float h = heuristic(nx, ny, endPos.first, endPos.second);
-                        openSet.push(Node(nx, ny, tentativeG, h));
-
-                        if (grid[ny][nx].type != CellType::Start && grid[ny][nx].type != CellType::End) {
-                            grid[ny][nx].type = CellType::Visited;
-                            drawGrid(window);
-                            window.display();
-                            sf::sleep(sf::milliseconds(visualizationDelay));
-                        }
-                    }
-                }
-            }
-        }
-        return false;
-    }
-
-    static void updateVisual(int y, int x, sf::RenderWindow& window) {
-        if (grid[y][x].type != CellType::Start && grid[y][x].type != CellType::End) {
-            grid[y][x].type = CellType::Visited;
-            drawGrid(window);
-            window.display();
-            sf::sleep(sf::milliseconds(visualizationDelay));
-        }
-    }
-
-    static void reconstructPath(const vector<vector<pair<int, int>>>& parent, sf::RenderWindow& window) {
-        pair<int, int> current = endPos;
-        while (current != startPos) {
-            grid[current.second][current.first].type = CellType::Path;
-            current = parent[current.second][current.first];
-            drawGrid(window);
-            window.display();
-            sf::sleep(sf::milliseconds(visualizationDelay));
-        }
-    }
-};
-
-void handleMouseClick(sf::RenderWindow& window, sf::Event::MouseButtonEvent event) {
-    if (currentState != State::IDLE) return;
-
-    sf::Vector2i mousePos = sf::Mouse::getPosition(window);
-    if (mousePos.x >= WINDOW_WIDTH - UI_WIDTH) return;
-
-    int gridX = mousePos.x / CELL_SIZE;
-    int gridY = mousePos.y / CELL_SIZE;
-
-    if (gridX < 0 || gridX >= GRID_SIZE || gridY < 0 || gridY >= GRID_SIZE) return;
-
-    Cell& cell = grid[gridY][gridX];
-
-    if (event.button == sf::Mouse::Left) {
-        if (cell.type == CellType::Empty) {
-            if (startPos.first == -1) {
-                startPos = { gridX, gridY };
-                cell.type = CellType::Start;
-            }
-            else if (endPos.first == -1) {
-                endPos = { gridX, gridY };
-                cell.type = CellType::End;
-            }
-            else {
-                cell.type = CellType::Wall;
-            }
-        }
-        else if (cell.type == CellType::Start) {
-            startPos = { -1, -1 };
-            cell.type = CellType::Empty;
-        }
-        else if (cell.type == CellType::End) {
-            endPos = { -1, -1 };
-            cell.type = CellType::Empty;
-        }
-    }
-    else if (event.button == sf::Mouse::Right) {
-        if (cell.type == CellType::Wall) {
-            cell.type = CellType::Empty;
-        }
-        else if (cell.type == CellType::Start) {
-            startPos = { -1, -1 };
-            cell.type = CellType::Empty;
-        }
-        else if (cell.type == CellType::End) {
-            endPos = { -1, -1 };
-            cell.type = CellType::Empty;
-        }
-    }
-
-    drawGrid(window);
-    window.display();
-}
-
-void drawUI(sf::RenderWindow& window) {
-    // UI Background
-    sf::RectangleShape panel(sf::Vector2f(UI_WIDTH, WINDOW_HEIGHT));
-    panel.setPosition(WINDOW_WIDTH - UI_WIDTH, 0);
-    panel.setFillColor(sf::Color(50, 50, 50));
-    window.draw(panel);
-
-    float btnX = WINDOW_WIDTH - UI_WIDTH + 20;
-    float btnY = 20;
-
-    // Section 1: Pathfinding Algorithms
-    sf::Text algoTitle("Pathfinding Algorithms", font, 24);
-    algoTitle.setPosition(btnX, btnY);
-    algoTitle.setFillColor(Colors::Text);
-    window.draw(algoTitle);
-
-    vector<sf::RectangleShape> algoBtns;
-    vector<sf::Text> algoTexts;
-    vector<string> algoLabels = { "BFS", "DFS", "A*", "Dijkstra", "Greedy" };
-
-    for (size_t i = 0; i < algoLabels.size(); ++i) {
-        sf::RectangleShape btn(sf::Vector2f(UI_WIDTH - 40, BTN_HEIGHT));
-        btn.setPosition(btnX, btnY + 40 + i * (BTN_HEIGHT + BTN_SPACING));
-        btn.setFillColor(Colors::Button);
-        algoBtns.push_back(btn);
-
-        sf::Text text(algoLabels[i], font, 20);
-        text.setPosition(btnX + 10, btnY + 45 + i * (BTN_HEIGHT + BTN_SPACING));
-        text.setFillColor(Colors::Text);
-        algoTexts.push_back(text);
-    }
-
-    // Section 2: Maze Generation Button
-    float mazeBtnY = btnY + 40 + (algoLabels.size() * (BTN_HEIGHT + BTN_SPACING)) + 20;
-    sf::RectangleShape mazeBtn(sf::Vector2f(UI_WIDTH - 40, BTN_HEIGHT));
-    mazeBtn.setPosition(btnX, mazeBtnY);
-    mazeBtn.setFillColor(Colors::Button);
-    window.draw(mazeBtn);
-
-    sf::Text mazeText("Generate Random Maze", font, 18);
-    mazeText.setPosition(btnX + 10, mazeBtnY + 5);
-    mazeText.setFillColor(Colors::Text);
-    window.draw(mazeText);
-
-    // Section 3: Results
-    sf::Text resultsTitle("Results", font, 24);
-    resultsTitle.setPosition(btnX, mazeBtnY + BTN_HEIGHT + BTN_SPACING + 20);
-    resultsTitle.setFillColor(Colors::Text);
-    window.draw(resultsTitle);
-
-    // Benchmark Text
-    stringstream benchText;
-    benchText << "Time: " << fixed << setprecision(3) << lastBenchmark << "s\n"
-        << "Status: " << statusMessage << "\n"
-        << "Result: " << (pathFound ? "Path found" : "No path");
-    sf::Text benchmarkText(benchText.str(), font, 20);
-    benchmarkText.setPosition(btnX, resultsTitle.getPosition().y + 40);
-    benchmarkText.setFillColor(Colors::Text);
-    window.draw(benchmarkText);
-
-    // Section 4: Reset Grid Button (at bottom)
-    sf::RectangleShape resetBtn(sf::Vector2f(UI_WIDTH - 40, BTN_HEIGHT));
-    resetBtn.setPosition(btnX, WINDOW_HEIGHT - BTN_HEIGHT - 20);
-    resetBtn.setFillColor(Colors::Button);
-    window.draw(resetBtn);
-
-    sf::Text resetText("Reset Grid", font, 20);
-    resetText.setPosition(btnX + 10, WINDOW_HEIGHT - BTN_HEIGHT - 15);
-    resetText.setFillColor(Colors::Text);
-    window.draw(resetText);
-
-    // Draw all buttons and text
-    for (const auto& btn : algoBtns) window.draw(btn);
-    for (const auto& text : algoTexts) window.draw(text);
-}
-int main() {
-    sf::RenderWindow window(sf::VideoMode(WINDOW_WIDTH, WINDOW_HEIGHT), "Pathfinding Visualizer");
-    window.setFramerateLimit(60); // Limit frame rate to 60 FPS
-    // HWND hwnd = GetConsoleWindow();
-    // ShowWindow(hwnd, SW_HIDE);
-
-    if (!font.loadFromFile("assets/fonts/arvo.ttf")) {
-        cerr << "Failed to load font!" << endl;
-        return EXIT_FAILURE;
-    }
-
-    // Initialize grid
-    for (int y = 0; y < GRID_SIZE; y++) {
-        for (int x = 0; x < GRID_SIZE; x++) {
-            grid[y][x] = Cell(x, y);
-        }
-    }
-
-    while (window.isOpen()) {
-        sf::Event event;
-        while (window.pollEvent(event)) {
-            if (event.type == sf::Event::Closed) {
-                window.close();
-            }
-
-            sf::Vector2f mousePos = window.mapPixelToCoords(sf::Mouse::getPosition(window));
-
-            if (event.type == sf::Event::MouseButtonPressed) {
-                sf::Vector2f mousePos = window.mapPixelToCoords(sf::Mouse::getPosition(window));
-                // Handle Reset Grid Button
-                sf::RectangleShape resetBtn(sf::Vector2f(UI_WIDTH - 40, BTN_HEIGHT));
-                resetBtn.setPosition(WINDOW_WIDTH - UI_WIDTH + 20, WINDOW_HEIGHT - BTN_HEIGHT - 20);
-
-                if (resetBtn.getGlobalBounds().contains(mousePos) && currentState == State::IDLE) {
-                    // Reset ALL cells to Empty
-                    for (auto& row : grid) {
-                        for (auto& cell : row) {
-                            cell.type = CellType::Empty;
-                        }
-                    }
-                    startPos = { -1, -1 };
-                    endPos = { -1, -1 };
-                    pathFound = false;
-                    lastBenchmark = 0.0;
-                    statusMessage = "Grid Reset";
-                }
-
-                // Handle Pathfinding Algorithm Buttons
-                vector<sf::RectangleShape> algoBtns;
-                vector<string> algoLabels = { "BFS", "DFS", "A*", "Dijkstra", "Greedy" };
-                float btnX = WINDOW_WIDTH - UI_WIDTH + 20;
-                float mazeBtnY = 20 + 40 + (algoLabels.size() * (BTN_HEIGHT + BTN_SPACING)) + 20;
-                float btnY = 20;
-
-                for (size_t i = 0; i < algoLabels.size(); ++i) {
-                    sf::RectangleShape btn(sf::Vector2f(UI_WIDTH - 40, BTN_HEIGHT));
-                    btn.setPosition(btnX, btnY + 40 + i * (BTN_HEIGHT + BTN_SPACING));
-                    algoBtns.push_back(btn);
-
-                    if (btn.getGlobalBounds().contains(mousePos) && currentState == State::IDLE) {
-                        currentState = State::VISUALIZING;
-                        currentAlgorithm = static_cast<Algorithm>(i);
-                        double duration;
-                        pathFound = Pathfinder::findPath(currentAlgorithm, window, duration);
-                        statusMessage = pathFound ? "Path found!" : "No path found";
-                        currentState = State::IDLE;
-                    }
-                }
-
-                // Handle Maze Generation Button
-                sf::RectangleShape mazeBtn(sf::Vector2f(UI_WIDTH - 40, BTN_HEIGHT));
-                mazeBtn.setPosition(btnX, mazeBtnY);
-
-                if (mazeBtn.getGlobalBounds().contains(mousePos) && currentState == State::IDLE) {
-                    cout << "Maze Generation button clicked!" << endl; // Debug statement
-                    MazeGenerator::generateRandomWalls(0.3); // Generate random walls
-                    statusMessage = "Maze Generated";
-                }
-
-                // Handle grid editing
-                if (mousePos.x < WINDOW_WIDTH - UI_WIDTH) {
-                    handleMouseClick(window, event.mouseButton);
-                }
-            }
-        }
-
-        // Rendering
-        window.clear(Colors::Background);
-        drawGrid(window);
-        drawUI(window);
-        window.display();
-    }
-
-    return 0;
+#include <SFML/Graphics.hpp>
+#include "core/MapIO.hpp"
+#include "core/MazeGenerator.hpp"
+#include "core/Pathfinder.hpp"
+#include "core/SearchStats.hpp"
+#include "core/SearchTrace.hpp"
+#include "gui/GridRenderer.hpp"
+#include "gui/SearchPlayback.hpp"
+#include "gui/TraceReplay.hpp"
+// #include<Windows.h>
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include <sstream>
+#include <iomanip>
+#include <cctype>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <cstdlib>
+using namespace std;
+using namespace chrono;
+
+// Reports every allocation to the search core, so the results panel can show
+// the bytes each search allocated.
+void* operator new(size_t size) {
+    void* block = malloc(size ? size : 1);
+    if (!block) throw bad_alloc();
+    Pathfinding::AllocationCounter::record(size);
+    return block;
+}
+
+void operator delete(void* ptr) noexcept { free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { free(ptr); }
+
+// Constants
+const int WINDOW_WIDTH = 1200;
+const int WINDOW_HEIGHT = 800;
+const int GRID_SIZE = 40;
+const int MAX_GRID_SIZE = 8192; // one texel per cell; most GPUs take textures up to this size
+const string GRID_SIZE_ERROR = "Grid sides must be from 1 to " + to_string(MAX_GRID_SIZE) + " cells";
+const int UI_WIDTH = 300;
+const int BTN_HEIGHT = 40;
+const int BTN_SPACING = 10;
+const int TIMELINE_HEIGHT = 30; // replay mode's scrub bar, below the grid panes
+enum class CellType : uint8_t { Empty, Wall, Start, End, Path, Visited };
+using Pathfinding::Algorithm;
+using Pathfinding::Point;
+enum class State { IDLE, VISUALIZING };
+
+// Button labels in Algorithm order, laid out two per row.
+const vector<string> ALGO_LABELS = { "BFS", "DFS", "A*", "Dijkstra", "Greedy", "JPS", "JPS+", "Bi-BFS", "Bi-A*", "Wave BFS", "D* Lite", "HPA*", "ALT", "Flow Field" };
+const int ALGO_BTN_WIDTH = (UI_WIDTH - 40 - BTN_SPACING) / 2;
+const int ALGO_BTN_ROWS = (static_cast<int>(ALGO_LABELS.size()) + 1) / 2;
+
+sf::Vector2f algoButtonPosition(size_t i) {
+    return sf::Vector2f(WINDOW_WIDTH - UI_WIDTH + 20 + (i % 2) * (ALGO_BTN_WIDTH + BTN_SPACING),
+        60 + (i / 2) * (BTN_HEIGHT + BTN_SPACING));
+}
+
+// Walls live in the core grid's bitmap; cellStates holds one byte of display
+// state per cell, indexed the same way as the grid.
+Pathfinding::Grid grid(GRID_SIZE, GRID_SIZE);
+vector<CellType> cellStates(grid.cellCount(), CellType::Empty);
+GridRenderer gridRenderer;
+// D* Lite keeps its tree between runs, so rerunning it after editing walls
+// only repairs (and replays) the cells the edits affected.
+Pathfinding::IncrementalPlanner planner;
+sf::Font font;
+Point startPos, endPos;
+int stepsPerFrame = 1; // search events played back per frame at 1x speed
+int terrainBrush = 1;  // keys 1-9: left-click draws walls at 1, terrain of that cost above
+Pathfinding::Connectivity moves = Pathfinding::Connectivity::Four; // D toggles diagonal moves
+bool recordTraces = false; // T: also write each visual run to traces/<algorithm>.pftrace
+string traceStatus = "off";
+// G cycles the maze button through random walls and the maze algorithms.
+const vector<string> MAZE_STYLES = { "Random walls", "Backtracker", "Kruskal", "Prim", "Eller", "Wilson" };
+int mazeStyle = 0;
+
+Algorithm currentAlgorithm = Algorithm::BFS;
+string statusMessage = "Ready";
+Pathfinding::SearchStats lastStats;
+bool pathFound = false;
+State currentState = State::IDLE;
+bool panelChanged = true; // the results text needs laying out again
+
+namespace Colors {
+    const sf::Color Background(40, 40, 40);
+    const sf::Color Wall(30, 30, 30);
+    const sf::Color Start(0, 200, 0);
+    const sf::Color End(200, 0, 0);
+    const sf::Color Path(255, 255, 100);
+    const sf::Color Visited(100, 200, 255);
+    const sf::Color Button(70, 70, 70);
+    const sf::Color ButtonHover(100, 100, 100);
+    const sf::Color Text(255, 255, 255);
+}
+
+sf::Color cellColor(CellType type) {
+    switch (type) {
+    case CellType::Wall: return Colors::Wall;
+    case CellType::Start: return Colors::Start;
+    case CellType::End: return Colors::End;
+    case CellType::Path: return Colors::Path;
+    case CellType::Visited: return Colors::Visited;
+    default: return sf::Color::White;
+    }
+}
+
+// Empty cells fade from white to brown as their terrain cost rises.
+sf::Color terrainColor(int cost) {
+    float t = float(cost - 1) / (Pathfinding::Grid::kMaxCost - 1);
+    return sf::Color(static_cast<sf::Uint8>(255 - 105 * t), static_cast<sf::Uint8>(255 - 145 * t),
+        static_cast<sf::Uint8>(255 - 185 * t));
+}
+
+// Updates the display state of a cell without touching the walls.
+void paintCell(int index, CellType type) {
+    cellStates[index] = type;
+    gridRenderer.setCell(index, type == CellType::Empty ? terrainColor(grid.cost(index)) : cellColor(type));
+}
+
+void setTerrain(int index, int cost) {
+    Point p = grid.point(index);
+    grid.setCost(p.x, p.y, cost);
+    paintCell(index, cellStates[index]);
+}
+
+void setCellType(int index, CellType type) {
+    paintCell(index, type);
+    Point p = grid.point(index);
+    grid.setWall(p.x, p.y, type == CellType::Wall);
+}
+
+bool validGridSize(int width, int height) {
+    return width >= 1 && height >= 1 && width <= MAX_GRID_SIZE && height <= MAX_GRID_SIZE;
+}
+
+// Sizes the grid and its renderer; cells shrink below a pixel for large maps.
+void resizeGrid(int width, int height) {
+    grid.resize(width, height);
+    cellStates.assign(grid.cellCount(), CellType::Empty);
+    float cellSize = min(WINDOW_HEIGHT, WINDOW_WIDTH - UI_WIDTH) / float(max(width, height));
+    if (cellSize >= 1.0f) cellSize = floor(cellSize);
+    gridRenderer.resize(width, height, cellSize);
+    stepsPerFrame = max(1, grid.cellCount() / 800);
+    startPos = Point();
+    endPos = Point();
+}
+
+// Fills the grid with walls in the selected style over random terrain,
+// keeping the start and end cells open.
+void generateMaze() {
+    uint64_t seed = chrono::system_clock::now().time_since_epoch().count();
+    if (mazeStyle == 0) Pathfinding::MazeGenerator::generateRandomWalls(grid, 0.3, seed);
+    else Pathfinding::MazeGenerator::generateMaze(grid, static_cast<Pathfinding::MazeAlgorithm>(mazeStyle - 1), seed);
+    Pathfinding::MazeGenerator::generateTerrain(grid, Pathfinding::Grid::kMaxCost, seed + 1);
+
+    for (int i = 0; i < grid.cellCount(); ++i) {
+        if (cellStates[i] == CellType::Start || cellStates[i] == CellType::End) {
+            setCellType(i, cellStates[i]);
+        }
+        else {
+            setCellType(i, grid.isWall(i) ? CellType::Wall : CellType::Empty);
+        }
+    }
+}
+
+// Replaces the grid with a MovingAI .map or ASCII map file.
+void loadMap(const string& path) {
+    Pathfinding::Grid loaded = filesystem::path(path).extension() == ".map"
+        ? Pathfinding::MapIO::loadMovingAIMap(path) : Pathfinding::MapIO::loadAsciiMap(path);
+    if (!validGridSize(loaded.width(), loaded.height())) throw runtime_error(GRID_SIZE_ERROR);
+    resizeGrid(loaded.width(), loaded.height());
+    grid = loaded;
+    for (int i = 0; i < grid.cellCount(); ++i) paintCell(i, grid.isWall(i) ? CellType::Wall : CellType::Empty);
+}
+
+void drawGrid(sf::RenderWindow& window) {
+    gridRenderer.draw(window);
+}
+
+void drawUI(sf::RenderWindow& window);
+
+void renderFrame(sf::RenderWindow& window) {
+    window.clear(Colors::Background);
+    drawGrid(window);
+    drawUI(window);
+    window.display();
+}
+
+SearchPlayback playback;
+
+// Outcome of the run being played back. Written by the worker thread and only
+// read once playback reports the worker has finished.
+struct RunResult {
+    bool found = false;
+    Pathfinding::SearchStats stats;
+    bool traceWritten = false;
+};
+RunResult runResult;
+string tracePath; // file the run being played back is recorded to, if any
+
+// Trace file name for an algorithm's button label, e.g. "Bi-A*" -> "bi-astar".
+string traceName(const string& label) {
+    string name;
+    for (char c : label) {
+        if (isalnum(static_cast<unsigned char>(c))) name += static_cast<char>(tolower(static_cast<unsigned char>(c)));
+        else if (c == '*') name += "star";
+        else if (c == '+') name += "plus";
+        else name += '-';
+    }
+    return name;
+}
+
+// Calls run with the visual observer, teed into the trace writer when the run
+// is being recorded. Returns whether the whole trace reached the disk.
+template <class Observer, class Run>
+bool withTrace(Observer& observer, Pathfinding::TraceWriter* trace, Run&& run) {
+    if (!trace) {
+        run(observer);
+        return false;
+    }
+    Pathfinding::TeeObserver<Observer, Pathfinding::TraceWriter> both(observer, *trace);
+    run(both);
+    return trace->close();
+}
+
+// Clears the previous run and starts the algorithm on the playback worker. The
+// measured run is headless, so its counters and timings cover only the search;
+// a second run streams its events to the render loop.
+void startSearch(Algorithm algo) {
+    for (int i = 0; i < grid.cellCount(); ++i) {
+        if (cellStates[i] == CellType::Visited || cellStates[i] == CellType::Path) {
+            paintCell(i, CellType::Empty);
+        }
+    }
+
+    // The writer is opened here, so a file that cannot be created is reported
+    // before the worker starts.
+    shared_ptr<Pathfinding::TraceWriter> trace;
+    tracePath.clear();
+    traceStatus = recordTraces ? "recording" : "off";
+    if (recordTraces) {
+        string path = "traces/" + traceName(ALGO_LABELS[static_cast<size_t>(algo)]) + ".pftrace";
+        error_code error;
+        filesystem::create_directories("traces", error);
+        try {
+            trace = make_shared<Pathfinding::TraceWriter>(path, grid, grid.index(startPos.x, startPos.y), grid.index(endPos.x, endPos.y));
+            tracePath = path;
+        }
+        catch (const exception&) {
+            traceStatus = "cannot write " + path;
+        }
+    }
+
+    currentState = State::VISUALIZING;
+    statusMessage = "Searching...";
+    playback.start([algo, start = startPos, end = endPos, moves = moves, trace](Pathfinding::QueueObserver& observer) {
+        Pathfinding::StatsObserver stats;
+        if (algo == Algorithm::DStarLite) {
+            // A second headless run would find nothing left to repair, so
+            // measure the observed replan itself.
+            Pathfinding::SearchResult result;
+            bool written = withTrace(observer, trace.get(), [&](auto& visual) {
+                Pathfinding::TeeObserver<Pathfinding::StatsObserver, remove_reference_t<decltype(visual)>> both(stats, visual);
+                stats.onPhase(Pathfinding::SearchPhase::Setup);
+                result = planner.plan(grid, grid.index(start.x, start.y), grid.index(end.x, end.y), both);
+                stats.onPhase(Pathfinding::SearchPhase::Done);
+                });
+            runResult = { result.found, stats.stats(), written };
+            return;
+        }
+
+        Pathfinding::SearchResult result = Pathfinding::Pathfinder::findPath(algo, grid, start, end, stats, moves);
+        runResult = { result.found, stats.stats() };
+
+        runResult.traceWritten = withTrace(observer, trace.get(), [&](auto& visual) {
+            Pathfinding::Pathfinder::findPath(algo, grid, start, end, visual, moves);
+            });
+        });
+}
+
+void applySearchEvent(const Pathfinding::SearchEvent& event) {
+    CellType type = cellStates[event.index];
+    if (type == CellType::Start || type == CellType::End) return;
+    paintCell(event.index, event.type == Pathfinding::SearchEvent::Type::Path ? CellType::Path : CellType::Visited);
+}
+
+void updatePlayback() {
+    if (currentState != State::VISUALIZING) return;
+
+    playback.update(stepsPerFrame, applySearchEvent);
+    if (playback.isDone()) {
+        pathFound = runResult.found;
+        lastStats = runResult.stats;
+        statusMessage = pathFound ? "Path found!" : "No path found";
+        if (!tracePath.empty()) traceStatus = runResult.traceWritten ? tracePath : "cannot write " + tracePath;
+        currentState = State::IDLE;
+        panelChanged = true;
+    }
+}
+
+void handlePlaybackKey(sf::Keyboard::Key key) {
+    if (currentState != State::VISUALIZING) return;
+
+    switch (key) {
+    case sf::Keyboard::Space: playback.togglePause(); break;
+    case sf::Keyboard::Right: playback.step(applySearchEvent); break;
+    case sf::Keyboard::Up: playback.faster(); break;
+    case sf::Keyboard::Down: playback.slower(); break;
+    case sf::Keyboard::Enter: playback.finish(); break;
+    default: break;
+    }
+}
+
+void handleMouseClick(sf::RenderWindow& window, sf::Event::MouseButtonEvent event) {
+    if (currentState != State::IDLE) return;
+
+    sf::Vector2i mousePos = sf::Mouse::getPosition(window);
+    if (mousePos.x >= WINDOW_WIDTH - UI_WIDTH) return;
+
+    int gridX = static_cast<int>(mousePos.x / gridRenderer.getCellSize());
+    int gridY = static_cast<int>(mousePos.y / gridRenderer.getCellSize());
+
+    if (!grid.inBounds(gridX, gridY)) return;
+
+    int index = grid.index(gridX, gridY);
+    CellType type = cellStates[index];
+
+    if (event.button == sf::Mouse::Left) {
+        if (type == CellType::Empty) {
+            if (startPos.x == -1) {
+                startPos = { gridX, gridY };
+                setCellType(index, CellType::Start);
+            }
+            else if (endPos.x == -1) {
+                endPos = { gridX, gridY };
+                setCellType(index, CellType::End);
+            }
+            else if (terrainBrush == 1) {
+                setCellType(index, CellType::Wall);
+            }
+            else {
+                setTerrain(index, terrainBrush);
+            }
+        }
+        else if (type == CellType::Start) {
+            startPos = Point();
+            setCellType(index, CellType::Empty);
+        }
+        else if (type == CellType::End) {
+            endPos = Point();
+            setCellType(index, CellType::Empty);
+        }
+    }
+    else if (event.button == sf::Mouse::Right) {
+        if (type == CellType::Wall) {
+            setCellType(index, CellType::Empty);
+        }
+        else if (type == CellType::Empty) {
+            setTerrain(index, 1);
+        }
+        else if (type == CellType::Start) {
+            startPos = Point();
+            setCellType(index, CellType::Empty);
+        }
+        else if (type == CellType::End) {
+            endPos = Point();
+            setCellType(index, CellType::Empty);
+        }
+    }
+}
+
+// Playback speed as shown in the panel, e.g. "4x" or "1/8x".
+string speedLabel(double speed) {
+    if (speed >= 1.0) return to_string(static_cast<int>(speed)) + "x";
+    return "1/" + to_string(static_cast<int>(1.0 / speed)) + "x";
+}
+
+// The side panel is retained: buildPanel() lays out the buttons, their labels
+// and hit rectangles once, after the font loads. Only the two result texts
+// change, and they are re-laid out when panelChanged is set, after input or
+// a finished run, rather than every frame.
+struct Panel {
+    sf::VertexArray quads{ sf::Quads };  // background and buttons, drawn in one call
+    vector<sf::Text> labels;             // titles and button captions
+    vector<sf::FloatRect> algoButtons;   // in Algorithm order
+    sf::FloatRect mazeButton, resetButton;
+    sf::Text results, stats;
+};
+Panel panel;
+
+void addQuad(sf::VertexArray& quads, const sf::FloatRect& rect, const sf::Color& color) {
+    quads.append(sf::Vertex(sf::Vector2f(rect.left, rect.top), color));
+    quads.append(sf::Vertex(sf::Vector2f(rect.left + rect.width, rect.top), color));
+    quads.append(sf::Vertex(sf::Vector2f(rect.left + rect.width, rect.top + rect.height), color));
+    quads.append(sf::Vertex(sf::Vector2f(rect.left, rect.top + rect.height), color));
+}
+
+void addLabel(const string& text, unsigned size, float x, float y) {
+    sf::Text label(text, font, size);
+    label.setPosition(x, y);
+    label.setFillColor(Colors::Text);
+    panel.labels.push_back(label);
+}
+
+void addButton(const sf::FloatRect& rect, const string& text, unsigned size) {
+    addQuad(panel.quads, rect, Colors::Button);
+    addLabel(text, size, rect.left + 10, rect.top + 5);
+}
+
+void buildPanel() {
+    float btnX = WINDOW_WIDTH - UI_WIDTH + 20;
+    float mazeBtnY = 20 + 40 + (ALGO_BTN_ROWS * (BTN_HEIGHT + BTN_SPACING)) + 20;
+    float resultsY = mazeBtnY + BTN_HEIGHT + BTN_SPACING + 20;
+
+    addQuad(panel.quads, sf::FloatRect(WINDOW_WIDTH - UI_WIDTH, 0, UI_WIDTH, WINDOW_HEIGHT), sf::Color(50, 50, 50));
+
+    // Section 1: Pathfinding Algorithms
+    addLabel("Pathfinding Algorithms", 24, btnX, 20);
+    for (size_t i = 0; i < ALGO_LABELS.size(); ++i) {
+        panel.algoButtons.push_back(sf::FloatRect(algoButtonPosition(i), sf::Vector2f(ALGO_BTN_WIDTH, BTN_HEIGHT)));
+        addButton(panel.algoButtons.back(), ALGO_LABELS[i], 20);
+    }
+
+    // Section 2: Maze Generation Button
+    panel.mazeButton = sf::FloatRect(btnX, mazeBtnY, UI_WIDTH - 40, BTN_HEIGHT);
+    addButton(panel.mazeButton, "Generate Maze", 18);
+
+    // Section 3: Results
+    addLabel("Results", 24, btnX, resultsY);
+    panel.results = sf::Text("", font, 20);
+    panel.results.setPosition(btnX, resultsY + 40);
+    panel.results.setFillColor(Colors::Text);
+    // Counters from the last run, in a smaller font to fit above the reset button.
+    panel.stats = sf::Text("", font, 14);
+    panel.stats.setFillColor(Colors::Text);
+
+    // Section 4: Reset Grid Button (at bottom)
+    panel.resetButton = sf::FloatRect(btnX, WINDOW_HEIGHT - BTN_HEIGHT - 20, UI_WIDTH - 40, BTN_HEIGHT);
+    addButton(panel.resetButton, "Reset Grid", 20);
+}
+
+void layoutResults() {
+    stringstream benchText;
+    benchText << "Time: " << fixed << setprecision(3) << lastStats.totalNs() / 1e6 << " ms\n"
+        << "Status: " << statusMessage << "\n"
+        << "Result: " << (pathFound ? "Path found" : "No path") << "\n"
+        << "Brush: " << (terrainBrush == 1 ? string("walls") : "cost " + to_string(terrainBrush))
+        << "   Moves: " << (moves == Pathfinding::Connectivity::Eight ? "8-way" : "4-way") << "\n"
+        << "Playback: " << speedLabel(playback.speed());
+    if (playback.isPaused()) benchText << " (paused)";
+    panel.results.setString(benchText.str());
+
+    stringstream statsText;
+    statsText << "Expanded " << lastStats.expanded << "   Generated " << lastStats.generated << "\n"
+        << "Pushes " << lastStats.pushes << "   Pops " << lastStats.pops << "   Stale " << lastStats.stalePops << "\n"
+        << "Peak open " << lastStats.peakOpen << "   Alloc " << fixed << setprecision(1) << lastStats.bytesAllocated / 1024.0 << " KB\n"
+        << setprecision(3) << "Setup " << lastStats.setupNs / 1e6 << "  Search " << lastStats.searchNs / 1e6
+        << "  Path " << lastStats.reconstructNs / 1e6 << " ms\n"
+        << "Maze (G): " << MAZE_STYLES[mazeStyle] << "\n"
+        << "Trace (T): " << traceStatus;
+    panel.stats.setString(statsText.str());
+    panel.stats.setPosition(panel.results.getPosition().x,
+        panel.results.getPosition().y + panel.results.getLocalBounds().height + 16);
+}
+
+void drawUI(sf::RenderWindow& window) {
+    if (panelChanged) {
+        layoutResults();
+        panelChanged = false;
+    }
+    window.draw(panel.quads);
+    for (const sf::Text& label : panel.labels) window.draw(label);
+    window.draw(panel.results);
+    window.draw(panel.stats);
+}
+
+// --replay mode: one or two recorded traces side by side on a shared timeline.
+// Space pauses, Left/Right step, Up/Down change speed, Home/End jump to either
+// end, and clicking or dragging the timeline seeks.
+int runReplay(sf::RenderWindow& window, const vector<string>& paths) {
+    const TraceReplay::Palette palette{ sf::Color::White, Colors::Wall, Colors::Start, Colors::End, Colors::Visited, Colors::Path };
+    const float areaWidth = WINDOW_WIDTH - UI_WIDTH, areaHeight = WINDOW_HEIGHT - TIMELINE_HEIGHT;
+    const float paneWidth = (areaWidth - BTN_SPACING * (paths.size() - 1)) / paths.size();
+
+    vector<unique_ptr<TraceReplay>> panes;
+    uint64_t length = 0;
+    try {
+        for (const string& path : paths) {
+            panes.push_back(make_unique<TraceReplay>(path, palette, paneWidth, areaHeight));
+            length = max(length, panes.back()->length());
+        }
+    }
+    catch (const exception& error) {
+        cerr << error.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    // At 1x the longest trace plays in about ten seconds.
+    const double eventsPerFrame = max<uint64_t>(1, length / 600);
+    const sf::FloatRect timeline(0, areaHeight, areaWidth, TIMELINE_HEIGHT);
+    double position = 0.0;
+    int speedExponent = 0;
+    bool paused = false;
+
+    // The bar, panel and text persist between frames; only the progress bar's
+    // width and, when the step or speed changes, the info text are updated.
+    sf::RectangleShape track(sf::Vector2f(timeline.width, timeline.height - 10));
+    track.setPosition(timeline.left, timeline.top + 5);
+    track.setFillColor(Colors::Button);
+    sf::RectangleShape progress(track);
+    progress.setFillColor(Colors::Visited);
+    sf::RectangleShape panel(sf::Vector2f(UI_WIDTH, WINDOW_HEIGHT));
+    panel.setPosition(WINDOW_WIDTH - UI_WIDTH, 0);
+    panel.setFillColor(sf::Color(50, 50, 50));
+
+    float textX = WINDOW_WIDTH - UI_WIDTH + 20;
+    sf::Text title("Trace Replay", font, 24);
+    title.setPosition(textX, 20);
+    title.setFillColor(Colors::Text);
+    sf::Text infoText("", font, 16);
+    infoText.setPosition(textX, 70);
+    infoText.setFillColor(Colors::Text);
+    uint64_t shownStep = ~uint64_t(0);
+    int shownSpeed = speedExponent;
+    bool shownPaused = paused;
+
+    while (window.isOpen()) {
+        // Once a frame is up, paused or played to the end, and not scrubbing,
+        // nothing moves until the next input.
+        bool wait = shownStep != ~uint64_t(0) && (paused || position >= double(length)) && !sf::Mouse::isButtonPressed(sf::Mouse::Left);
+        sf::Event event;
+        while (wait ? window.waitEvent(event) : window.pollEvent(event)) {
+            wait = false;
+            if (event.type == sf::Event::Closed) window.close();
+            if (event.type != sf::Event::KeyPressed) continue;
+
+            switch (event.key.code) {
+            case sf::Keyboard::Space: paused = !paused; break;
+            case sf::Keyboard::Right: paused = true; position = floor(position) + 1; break;
+            case sf::Keyboard::Left: paused = true; position = ceil(position) - 1; break;
+            case sf::Keyboard::Up: speedExponent = min(speedExponent + 1, 10); break;
+            case sf::Keyboard::Down: speedExponent = max(speedExponent - 1, -6); break;
+            case sf::Keyboard::Home: position = 0.0; break;
+            case sf::Keyboard::End: position = double(length); break;
+            default: break;
+            }
+        }
+        if (!window.isOpen()) break;
+
+        sf::Vector2f mousePos = window.mapPixelToCoords(sf::Mouse::getPosition(window));
+        if (window.hasFocus() && sf::Mouse::isButtonPressed(sf::Mouse::Left) && timeline.contains(mousePos)) {
+            position = (mousePos.x - timeline.left) / timeline.width * length;
+        }
+        else if (!paused) {
+            position += eventsPerFrame * pow(2.0, speedExponent);
+        }
+        position = min(max(position, 0.0), double(length));
+        uint64_t step = static_cast<uint64_t>(position);
+        for (auto& pane : panes) pane->seek(step);
+
+        if (step != shownStep || speedExponent != shownSpeed || paused != shownPaused) {
+            stringstream info;
+            for (const auto& pane : panes) {
+                info << filesystem::path(pane->getName()).filename().string() << "\n"
+                    << "  Step " << pane->position() << " / " << pane->length() << "\n\n";
+            }
+            info << "Playback: " << speedLabel(pow(2.0, speedExponent)) << (paused ? " (paused)" : "") << "\n\n"
+                << "Space  pause/resume\n"
+                << "Left/Right  step\n"
+                << "Up/Down  faster/slower\n"
+                << "Home/End  jump to start/end\n"
+                << "Click the bar to seek";
+            infoText.setString(info.str());
+            shownStep = step;
+            shownSpeed = speedExponent;
+            shownPaused = paused;
+        }
+        progress.setSize(sf::Vector2f(length ? float(position / length) * timeline.width : 0.0f, timeline.height - 10));
+
+        window.clear(Colors::Background);
+        for (size_t i = 0; i < panes.size(); ++i) panes[i]->draw(window, sf::Vector2f(i * (paneWidth + BTN_SPACING), 0));
+        window.draw(track);
+        window.draw(progress);
+        window.draw(panel);
+        window.draw(title);
+        window.draw(infoText);
+        window.display();
+    }
+    return 0;
+}
+
+// Handles one window event. Returns whether the frame needs redrawing; plain
+// mouse movement changes nothing on screen.
+bool handleEvent(sf::RenderWindow& window, const sf::Event& event) {
+    if (event.type == sf::Event::Closed) {
+        playback.cancel();
+        window.close();
+        return false;
+    }
+
+    if (event.type == sf::Event::KeyPressed) {
+        handlePlaybackKey(event.key.code);
+        if (currentState == State::IDLE && event.key.code >= sf::Keyboard::Num1 && event.key.code <= sf::Keyboard::Num9) {
+            terrainBrush = event.key.code - sf::Keyboard::Num1 + 1;
+        }
+        if (currentState == State::IDLE && event.key.code == sf::Keyboard::D) {
+            moves = moves == Pathfinding::Connectivity::Four ? Pathfinding::Connectivity::Eight : Pathfinding::Connectivity::Four;
+        }
+        if (currentState == State::IDLE && event.key.code == sf::Keyboard::T) {
+            recordTraces = !recordTraces;
+            traceStatus = recordTraces ? "on" : "off";
+        }
+        if (currentState == State::IDLE && event.key.code == sf::Keyboard::G) {
+            mazeStyle = (mazeStyle + 1) % static_cast<int>(MAZE_STYLES.size());
+        }
+        panelChanged = true;
+    }
+
+    if (event.type == sf::Event::MouseButtonPressed) {
+        sf::Vector2f mousePos = window.mapPixelToCoords(sf::Mouse::getPosition(window));
+        if (panel.resetButton.contains(mousePos) && currentState == State::IDLE) {
+            // Reset ALL cells to Empty
+            resizeGrid(grid.width(), grid.height());
+            pathFound = false;
+            lastStats = Pathfinding::SearchStats();
+            statusMessage = "Grid Reset";
+        }
+
+        for (size_t i = 0; i < panel.algoButtons.size(); ++i) {
+            if (panel.algoButtons[i].contains(mousePos) && currentState == State::IDLE &&
+                startPos.x != -1 && endPos.x != -1) {
+                currentAlgorithm = static_cast<Algorithm>(i);
+                startSearch(currentAlgorithm);
+            }
+        }
+
+        if (panel.mazeButton.contains(mousePos) && currentState == State::IDLE) {
+            generateMaze();
+            statusMessage = "Maze Generated";
+        }
+
+        // Handle grid editing
+        if (mousePos.x < WINDOW_WIDTH - UI_WIDTH) {
+            handleMouseClick(window, event.mouseButton);
+        }
+        panelChanged = true;
+    }
+    return event.type != sf::Event::MouseMoved;
+}
+
+int main(int argc, char* argv[]) {
+    sf::RenderWindow window(sf::VideoMode(WINDOW_WIDTH, WINDOW_HEIGHT), "Pathfinding Visualizer");
+    window.setFramerateLimit(60); // Limit frame rate to 60 FPS
+    // HWND hwnd = GetConsoleWindow();
+    // ShowWindow(hwnd, SW_HIDE);
+
+    if (!font.loadFromFile("assets/fonts/arvo.ttf")) {
+        cerr << "Failed to load font!" << endl;
+        return EXIT_FAILURE;
+    }
+    // Landmark tables for maps loaded before are read back instead of rebuilt.
+    Pathfinding::LandmarkTable::setCacheDirectory(".pathfinding-cache");
+
+    // Optional grid dimensions: --grid <width>x<height>
+    int gridWidth = GRID_SIZE, gridHeight = GRID_SIZE;
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (string(argv[i]) != "--grid") continue;
+        if (sscanf(argv[i + 1], "%dx%d", &gridWidth, &gridHeight) != 2) {
+            cerr << "Expected --grid <width>x<height>" << endl;
+            return EXIT_FAILURE;
+        }
+        if (!validGridSize(gridWidth, gridHeight)) {
+            cerr << GRID_SIZE_ERROR << endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Replays recorded traces instead of editing a grid: --replay <trace> [<trace>]
+    vector<string> replayPaths;
+    for (int i = 1; i < argc; ++i) {
+        if (string(argv[i]) != "--replay") continue;
+        while (i + 1 < argc && replayPaths.size() < 2 && string(argv[i + 1]).rfind("--", 0) != 0) replayPaths.push_back(argv[++i]);
+        if (replayPaths.empty()) {
+            cerr << "Expected --replay <trace> [<trace>]" << endl;
+            return EXIT_FAILURE;
+        }
+    }
+    if (!replayPaths.empty()) return runReplay(window, replayPaths);
+
+    // Optional map file, which also sets the grid size: --map <file.map|ascii file>
+    string mapFile;
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (string(argv[i]) == "--map") mapFile = argv[i + 1];
+    }
+    if (mapFile.empty()) resizeGrid(gridWidth, gridHeight);
+    else {
+        try {
+            loadMap(mapFile);
+        }
+        catch (const exception& error) {
+            cerr << error.what() << endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    buildPanel();
+    // Idle windows block in waitEvent and redraw only after an event; frames
+    // run at the 60 FPS limit only while a search is playing back.
+    bool redraw = true;
+    while (window.isOpen()) {
+        sf::Event event;
+        if (currentState == State::IDLE && !redraw && window.waitEvent(event)) redraw = handleEvent(window, event);
+        while (window.pollEvent(event)) redraw |= handleEvent(window, event);
+        if (!window.isOpen()) break;
+
+        updatePlayback();
+        if (redraw || panelChanged || currentState == State::VISUALIZING) {
+            renderFrame(window);
+            redraw = false;
+        }
+    }
+
+    return 0;
 }
\ No newline at end of file